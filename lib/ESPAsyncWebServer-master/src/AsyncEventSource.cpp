@@ -177,14 +177,21 @@ AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest* request, A
 
 AsyncEventSourceClient::~AsyncEventSourceClient() {
 #ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lockmq);
+  std::lock_guard<std::mutex> lock(_lock);
 #endif
   _messageQueue.clear();
   close();
 }
 
 bool AsyncEventSourceClient::_queueMessage(const char* message, size_t len) {
-  if (_messageQueue.size() >= SSE_MAX_QUEUED_MESSAGES) {
+  bool queued;
+  {
+#ifdef ESP32
+    std::lock_guard<std::mutex> lock(_lockmq);
+#endif
+    queued = _messageQueue.emplace_back(message, len);
+  }
+  if (!queued) {
 #ifdef ESP8266
     ets_printf(String(F("ERROR: Too many messages queued\n")).c_str());
 #elif defined(ESP32)
@@ -193,28 +200,19 @@ bool AsyncEventSourceClient::_queueMessage(const char* message, size_t len) {
     return false;
   }
 
-#ifdef ESP32
-  // length() is not thread-safe, thus acquiring the lock before this call..
-  std::lock_guard<std::mutex> lock(_lockmq);
-#endif
-
-  _messageQueue.emplace_back(message, len);
-
-  /*
-    throttle queue run
-    if Q is filled for >25% then network/CPU is congested, since there is no zero-copy mode for socket buff
-    forcing Q run will only eat more heap ram and blow the buffer, let's just keep data in our own queue
-    the queue will be processed at least on each onAck()/onPoll() call from AsyncTCP
-  */
-  if (_messageQueue.size() < SSE_MAX_QUEUED_MESSAGES >> 2 && _client->canSend()) {
-    _runQueue();
-  }
-
+  _tryRunQueue();
   return true;
 }
 
 bool AsyncEventSourceClient::_queueMessage(AsyncEvent_SharedData_t&& msg) {
-  if (_messageQueue.size() >= SSE_MAX_QUEUED_MESSAGES) {
+  bool queued;
+  {
+#ifdef ESP32
+    std::lock_guard<std::mutex> lock(_lockmq);
+#endif
+    queued = _messageQueue.emplace_back(std::move(msg));
+  }
+  if (!queued) {
 #ifdef ESP8266
     ets_printf(String(F("ERROR: Too many messages queued\n")).c_str());
 #elif defined(ESP32)
@@ -223,29 +221,52 @@ bool AsyncEventSourceClient::_queueMessage(AsyncEvent_SharedData_t&& msg) {
     return false;
   }
 
-#ifdef ESP32
-  // length() is not thread-safe, thus acquiring the lock before this call..
-  std::lock_guard<std::mutex> lock(_lockmq);
-#endif
-
-  _messageQueue.emplace_back(std::move(msg));
+  _tryRunQueue();
+  return true;
+}
 
+void AsyncEventSourceClient::_tryRunQueue() {
   /*
     throttle queue run
     if Q is filled for >25% then network/CPU is congested, since there is no zero-copy mode for socket buff
     forcing Q run will only eat more heap ram and blow the buffer, let's just keep data in our own queue
     the queue will be processed at least on each onAck()/onPoll() call from AsyncTCP
   */
-  if (_messageQueue.size() < SSE_MAX_QUEUED_MESSAGES >> 2 && _client->canSend()) {
-    _runQueue();
+  if (_messageQueue.size() >= SSE_MAX_QUEUED_MESSAGES >> 2 || !_client || !_client->canSend())
+    return;
+
+#ifdef ESP32
+  // never wait for the network task: if it is sending from the queue, it runs it again for this message on release
+  _runPending = true;
+  std::unique_lock<std::mutex> lock(_lock, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+  _runPending = false;
+  _runQueue();
+  _unlockQueue(lock);
+#else
+  _runQueue();
+#endif
+}
+
+#ifdef ESP32
+// Releases _lock taken to send from the queue. A producer that failed to take it meanwhile left _runPending set:
+// run the queue for it, or leave it to whoever holds the lock now
+void AsyncEventSourceClient::_unlockQueue(std::unique_lock<std::mutex>& lock) {
+  while (true) {
+    lock.unlock();
+    if (!_runPending.load() || !lock.try_lock())
+      return;
+    _runPending = false;
+    if (_client && _client->canSend())
+      _runQueue();
   }
-  return true;
 }
+#endif
 
 void AsyncEventSourceClient::_onAck(size_t len __attribute__((unused)), uint32_t time __attribute__((unused))) {
 #ifdef ESP32
-  // Same here, acquiring the lock early
-  std::lock_guard<std::mutex> lock(_lockmq);
+  std::unique_lock<std::mutex> lock(_lock);
 #endif
 
   // adjust in-flight len
@@ -255,7 +276,7 @@ void AsyncEventSourceClient::_onAck(size_t len __attribute__((unused)), uint32_t
     _inflight = 0;
 
   // acknowledge as much messages's data as we got confirmed len from a AsyncTCP
-  while (len && _messageQueue.size()) {
+  while (len && !_messageQueue.empty()) {
     len = _messageQueue.front().ack(len);
     if (_messageQueue.front().finished()) {
       // now we could release full ack'ed messages, we were keeping it unless send confirmed from AsyncTCP
@@ -264,17 +285,22 @@ void AsyncEventSourceClient::_onAck(size_t len __attribute__((unused)), uint32_t
   }
 
   // try to send another batch of data
-  if (_messageQueue.size())
+  if (!_messageQueue.empty())
     _runQueue();
+#ifdef ESP32
+  _unlockQueue(lock);
+#endif
 }
 
 void AsyncEventSourceClient::_onPoll() {
-  if (_messageQueue.size()) {
+  if (!_messageQueue.empty()) {
 #ifdef ESP32
-    // Same here, acquiring the lock early
-    std::lock_guard<std::mutex> lock(_lockmq);
+    std::unique_lock<std::mutex> lock(_lock);
 #endif
     _runQueue();
+#ifdef ESP32
+    _unlockQueue(lock);
+#endif
   }
 }
 
@@ -307,9 +333,10 @@ void AsyncEventSourceClient::_runQueue() {
 
   // there is no need to lock the mutex here, 'cause all the calls to this method must be already lock'ed
   size_t total_bytes_written = 0;
-  for (auto i = _messageQueue.begin(); i != _messageQueue.end(); ++i) {
-    if (!i->sent()) {
-      const size_t bytes_written = i->write(_client);
+  for (size_t i = 0; i < _messageQueue.size(); ++i) {
+    AsyncEventSourceMessage& message = _messageQueue[i];
+    if (!message.sent()) {
+      const size_t bytes_written = message.write(_client);
       total_bytes_written += bytes_written;
       _inflight += bytes_written;
       if (bytes_written == 0 || _inflight > _max_inflight) {
@@ -344,6 +371,20 @@ void AsyncEventSource::_addClient(AsyncEventSourceClient* client) {
   std::lock_guard<std::mutex> lock(_client_queue_lock);
 #endif
   _clients.emplace_back(client);
+
+#if SSE_MAX_REPLAY_EVENTS
+  // send the events missed since Last-Event-ID, oldest first
+  if (client->lastId()) {
+    const size_t n = _replay.size();
+    const size_t oldest = n < SSE_MAX_REPLAY_EVENTS ? 0 : _replayNext;
+    for (size_t i = 0; i < n; i++) {
+      const auto& event = _replay[(oldest + i) % n];
+      if (event.first > client->lastId())
+        client->write(event.second);
+    }
+  }
+#endif
+
   if (_connectcb)
     _connectcb(client);
 
@@ -400,6 +441,17 @@ AsyncEventSource::SendStatus AsyncEventSource::send(
   AsyncEvent_SharedData_t shared_msg = std::make_shared<String>(generateEventMessage(message, event, id, reconnect));
 #ifdef ESP32
   std::lock_guard<std::mutex> lock(_client_queue_lock);
+#endif
+#if SSE_MAX_REPLAY_EVENTS
+  if (id) {
+    if (_replay.empty())
+      _replay.reserve(SSE_MAX_REPLAY_EVENTS);
+    if (_replay.size() < SSE_MAX_REPLAY_EVENTS)
+      _replay.emplace_back(id, shared_msg);
+    else
+      _replay[_replayNext] = std::make_pair(id, shared_msg);
+    _replayNext = (_replayNext + 1) % SSE_MAX_REPLAY_EVENTS;
+  }
 #endif
   size_t hits = 0;
   size_t miss = 0;
@@ -428,6 +480,12 @@ bool AsyncEventSource::canHandle(AsyncWebServerRequest* request) const {
   return request->isSSE() && request->url().equals(_url);
 }
 
+WebRouteMatch AsyncEventSource::routeKey(String& uri, WebRequestMethodComposite& methods) const {
+  uri = _url;
+  methods = HTTP_GET;
+  return ROUTE_EXACT;
+}
+
 void AsyncEventSource::handleRequest(AsyncWebServerRequest* request) {
   request->send(new AsyncEventSourceResponse(this));
 }
@@ -28,6 +28,9 @@
   #ifndef SSE_MAX_QUEUED_MESSAGES
     #define SSE_MAX_QUEUED_MESSAGES 32
   #endif
+  #ifndef SSE_MAX_REPLAY_EVENTS
+    #define SSE_MAX_REPLAY_EVENTS 16
+  #endif
   #define SSE_MIN_INFLIGH 2 * 1460  // allow 2 MSS packets
   #define SSE_MAX_INFLIGH 16 * 1024 // but no more than 16k, no need to blow it, since same data is kept in local Q
 #elif defined(ESP8266)
@@ -35,6 +38,9 @@
   #ifndef SSE_MAX_QUEUED_MESSAGES
     #define SSE_MAX_QUEUED_MESSAGES 8
   #endif
+  #ifndef SSE_MAX_REPLAY_EVENTS
+    #define SSE_MAX_REPLAY_EVENTS 4
+  #endif
   #define SSE_MIN_INFLIGH 2 * 1460 // allow 2 MSS packets
   #define SSE_MAX_INFLIGH 8 * 1024 // but no more than 8k, no need to blow it, since same data is kept in local Q
 #elif defined(TARGET_RP2040)
@@ -42,10 +48,14 @@
   #ifndef SSE_MAX_QUEUED_MESSAGES
     #define SSE_MAX_QUEUED_MESSAGES 32
   #endif
+  #ifndef SSE_MAX_REPLAY_EVENTS
+    #define SSE_MAX_REPLAY_EVENTS 16
+  #endif
   #define SSE_MIN_INFLIGH 2 * 1460  // allow 2 MSS packets
   #define SSE_MAX_INFLIGH 16 * 1024 // but no more than 16k, no need to blow it, since same data is kept in local Q
 #endif
 
+#include "AsyncSPSCQueue.h"
 #include <ESPAsyncWebServer.h>
 
 #ifdef ESP8266
@@ -131,13 +141,19 @@ class AsyncEventSourceClient {
     uint32_t _lastId{0};
     size_t _inflight{0};                   // num of unacknowledged bytes that has been written to socket buffer
     size_t _max_inflight{SSE_MAX_INFLIGH}; // max num of unacknowledged bytes that could be written to socket buffer
-    std::list<AsyncEventSourceMessage> _messageQueue;
+    AsyncSPSCQueue<AsyncEventSourceMessage, SSE_MAX_QUEUED_MESSAGES> _messageQueue;
 #ifdef ESP32
-    mutable std::mutex _lockmq;
+    mutable std::mutex _lockmq; // between producers only, never taken by the network task
+    mutable std::mutex _lock;   // whoever is sending from the queue
+    std::atomic<bool> _runPending{false}; // a producer found _lock taken: its holder runs the queue again
 #endif
     bool _queueMessage(const char* message, size_t len);
     bool _queueMessage(AsyncEvent_SharedData_t&& msg);
     void _runQueue();
+    void _tryRunQueue();
+#ifdef ESP32
+    void _unlockQueue(std::unique_lock<std::mutex>& lock);
+#endif
 
   public:
     AsyncEventSourceClient(AsyncWebServerRequest* request, AsyncEventSource* server);
@@ -220,6 +236,11 @@ class AsyncEventSource : public AsyncWebHandler {
 #endif
     ArEventHandlerFunction _connectcb = nullptr;
     ArEventHandlerFunction _disconnectcb = nullptr;
+#if SSE_MAX_REPLAY_EVENTS
+    // last events sent with an id, replayed to clients reconnecting with Last-Event-ID
+    std::vector<std::pair<uint32_t, AsyncEvent_SharedData_t>> _replay;
+    size_t _replayNext{0}; // oldest event once the ring is full
+#endif
 
     // this method manipulates in-fligh data size for connected client depending on number of active connections
     void _adjust_inflight_window();
@@ -253,7 +274,7 @@ class AsyncEventSource : public AsyncWebHandler {
      *
      * @param message body string, could be single or multi-line string sepprated by \n, \r, \r\n
      * @param event body string, a sinle line string
-     * @param id sequence id
+     * @param id sequence id, events with an id are kept for replay to clients reconnecting with an older Last-Event-ID (ids are expected to increase)
      * @param reconnect client's reconnect timeout
      * @return SendStatus if message was placed in any/all/part of the client's queues
      */
@@ -275,6 +296,7 @@ class AsyncEventSource : public AsyncWebHandler {
     void _addClient(AsyncEventSourceClient* client);
     void _handleDisconnect(AsyncEventSourceClient* client);
     bool canHandle(AsyncWebServerRequest* request) const override final;
+    WebRouteMatch routeKey(String& uri, WebRequestMethodComposite& methods) const override final;
     void handleRequest(AsyncWebServerRequest* request) override final;
 };
 
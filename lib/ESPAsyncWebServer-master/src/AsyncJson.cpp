@@ -102,6 +102,12 @@ bool AsyncCallbackJsonWebHandler::canHandle(AsyncWebServerRequest* request) cons
   return true;
 }
 
+WebRouteMatch AsyncCallbackJsonWebHandler::routeKey(String& uri, WebRequestMethodComposite& methods) const {
+  uri = _uri;
+  methods = _method;
+  return _uri.length() ? ROUTE_SEGMENT : ROUTE_PREFIX;
+}
+
 void AsyncCallbackJsonWebHandler::handleRequest(AsyncWebServerRequest* request) {
   if (_onRequest) {
     if (request->method() == HTTP_GET) {
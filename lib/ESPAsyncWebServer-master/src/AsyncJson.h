@@ -115,7 +115,10 @@ class AsyncCallbackJsonWebHandler : public AsyncWebHandler {
     AsyncCallbackJsonWebHandler(const String& uri, ArJsonRequestHandlerFunction onRequest = nullptr);
   #endif
 
-    void setMethod(WebRequestMethodComposite method) { _method = method; }
+    void setMethod(WebRequestMethodComposite method) {
+      _method = method;
+      AsyncWebRouter::invalidate();
+    }
     void setMaxContentLength(int maxContentLength) { _maxContentLength = maxContentLength; }
     void onRequest(ArJsonRequestHandlerFunction fn) { _onRequest = fn; }
 
@@ -124,6 +127,7 @@ class AsyncCallbackJsonWebHandler : public AsyncWebHandler {
     void handleUpload(__unused AsyncWebServerRequest* request, __unused const String& filename, __unused size_t index, __unused uint8_t* data, __unused size_t len, __unused bool final) override final {}
     void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override final;
     bool isRequestHandlerTrivial() const override final { return !_onRequest; }
+    WebRouteMatch routeKey(String& uri, WebRequestMethodComposite& methods) const override final;
 };
 
 #endif // ASYNC_JSON_SUPPORT == 1
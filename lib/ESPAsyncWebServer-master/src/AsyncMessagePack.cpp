@@ -57,6 +57,12 @@ bool AsyncCallbackMessagePackWebHandler::canHandle(AsyncWebServerRequest* reques
   return true;
 }
 
+WebRouteMatch AsyncCallbackMessagePackWebHandler::routeKey(String& uri, WebRequestMethodComposite& methods) const {
+  uri = _uri;
+  methods = _method;
+  return _uri.length() ? ROUTE_SEGMENT : ROUTE_PREFIX;
+}
+
 void AsyncCallbackMessagePackWebHandler::handleRequest(AsyncWebServerRequest* request) {
   if (_onRequest) {
     if (request->method() == HTTP_GET) {
@@ -0,0 +1,62 @@
+#ifndef ASYNCSPSCQUEUE_H_
+#define ASYNCSPSCQUEUE_H_
+
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Fixed capacity single-producer/single-consumer ring
+ * The producer only calls emplace_back(), the consumer everything else but size()/empty()/full(),
+ * which either side may call. Elements are constructed in place: no allocation after construction.
+ */
+template <typename T, size_t N>
+class AsyncSPSCQueue {
+  private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _slots[N];
+    std::atomic<size_t> _head{0}; // next element to pop, written by the consumer
+    std::atomic<size_t> _tail{0}; // next free slot, written by the producer
+
+    T* _slot(size_t i) { return reinterpret_cast<T*>(&_slots[i % N]); }
+
+  public:
+    AsyncSPSCQueue() {}
+    AsyncSPSCQueue(const AsyncSPSCQueue&) = delete;
+    AsyncSPSCQueue& operator=(const AsyncSPSCQueue&) = delete;
+    ~AsyncSPSCQueue() { clear(); }
+
+    size_t capacity() const { return N; }
+    size_t size() const { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() >= N; }
+
+    // producer: returns false when the ring is full
+    template <typename... Args>
+    bool emplace_back(Args&&... args) {
+      const size_t tail = _tail.load(std::memory_order_relaxed);
+      if (tail - _head.load(std::memory_order_acquire) >= N)
+        return false;
+      new (_slot(tail)) T(std::forward<Args>(args)...);
+      _tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    // consumer: i-th element from the front, i < size()
+    T& operator[](size_t i) { return *_slot(_head.load(std::memory_order_relaxed) + i); }
+    T& front() { return (*this)[0]; }
+
+    void pop_front() {
+      const size_t head = _head.load(std::memory_order_relaxed);
+      _slot(head)->~T();
+      _head.store(head + 1, std::memory_order_release);
+    }
+
+    void clear() {
+      while (!empty())
+        pop_front();
+    }
+};
+
+#endif /* ASYNCSPSCQUEUE_H_ */
@@ -127,6 +127,27 @@ size_t webSocketSendFrame(AsyncClient* client, bool final, uint8_t opcode, bool
   return len;
 }
 
+// Unmasked server frame holding the whole message, built once and shared by every client of a broadcast
+static AsyncWebSocketSharedBuffer __ws_frame(uint8_t opcode, const uint8_t* data, size_t len) {
+  size_t headLen = len < 126 ? 2 : (len <= 0xFFFF ? 4 : 10);
+  auto buffer = std::make_shared<std::vector<uint8_t>>(headLen + len);
+  uint8_t* buf = buffer->data();
+  buf[0] = 0x80 | (opcode & 0x0F);
+  if (headLen == 2) {
+    buf[1] = len;
+  } else if (headLen == 4) {
+    buf[1] = 126;
+    buf[2] = (uint8_t)(len >> 8);
+    buf[3] = (uint8_t)len;
+  } else {
+    buf[1] = 127;
+    for (size_t i = 0; i < 8; i++)
+      buf[9 - i] = (uint8_t)((uint64_t)len >> (8 * i));
+  }
+  std::memcpy(buf + headLen, data, len);
+  return buffer;
+}
+
 /*
  *    AsyncWebSocketMessageBuffer
  */
@@ -203,10 +224,11 @@ class AsyncWebSocketControl {
  * AsyncWebSocketMessage Message
  */
 
-AsyncWebSocketMessage::AsyncWebSocketMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode, bool mask) : _WSbuffer{buffer},
-                                                                                                             _opcode(opcode & 0x07),
-                                                                                                             _mask{mask},
-                                                                                                             _status{_WSbuffer ? WS_MSG_SENDING : WS_MSG_ERROR} {
+AsyncWebSocketMessage::AsyncWebSocketMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode, bool mask, bool framed) : _WSbuffer{buffer},
+                                                                                                                          _opcode(opcode & 0x07),
+                                                                                                                          _mask{mask},
+                                                                                                                          _framed{framed},
+                                                                                                                          _status{_WSbuffer ? WS_MSG_SENDING : WS_MSG_ERROR} {
 }
 
 void AsyncWebSocketMessage::ack(size_t len, uint32_t time) {
@@ -239,6 +261,21 @@ size_t AsyncWebSocketMessage::send(AsyncClient* client) {
   }
 
   size_t toSend = _WSbuffer->size() - _sent;
+
+  if (_framed) {
+    // the frame is already built: hand TCP as much of it as fits, no header per segment
+    toSend = std::min(toSend, client->space());
+    if (!toSend || !client->canSend())
+      return 0;
+    // bytes taken by add() are queued in the pcb: count them even if send() fails, they go out on the next flush
+    size_t added = client->add((const char*)_WSbuffer->data() + _sent, toSend);
+    _sent += added;
+    _ack += added;
+    if (added)
+      client->send();
+    return added;
+  }
+
   size_t window = webSocketSendFrameWindow(client);
 
   if (window < toSend) {
@@ -278,6 +315,7 @@ AsyncWebSocketClient::AsyncWebSocketClient(AsyncWebServerRequest* request, Async
   _clientId = _server->_getNextId();
   _status = WS_CONNECTED;
   _pstate = 0;
+  _pheaderLength = 0;
   _lastMessageTime = millis();
   _keepAlivePeriod = 0;
   _client->setRxTimeout(0);
@@ -311,7 +349,7 @@ void AsyncWebSocketClient::_onAck(size_t len, uint32_t time) {
   _lastMessageTime = millis();
 
 #ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lock);
+  std::unique_lock<std::mutex> lock(_lock);
 #endif
 
   if (!_controlQueue.empty()) {
@@ -336,6 +374,9 @@ void AsyncWebSocketClient::_onAck(size_t len, uint32_t time) {
   _clearQueue();
 
   _runQueue();
+#ifdef ESP32
+  _unlockQueue(lock);
+#endif
 }
 
 void AsyncWebSocketClient::_onPoll() {
@@ -352,7 +393,11 @@ void AsyncWebSocketClient::_onPoll() {
     lock.unlock();
 #endif
     ping((uint8_t*)AWSC_PING_PAYLOAD, AWSC_PING_PAYLOAD_LEN);
+    return;
   }
+#ifdef ESP32
+  _unlockQueue(lock);
+#endif
 }
 
 void AsyncWebSocketClient::_runQueue() {
@@ -364,30 +409,36 @@ void AsyncWebSocketClient::_runQueue() {
 
   if (!_controlQueue.empty() && (_messageQueue.empty() || _messageQueue.front().betweenFrames()) && webSocketSendFrameWindow(_client) > (size_t)(_controlQueue.front().len() - 1)) {
     _controlQueue.front().send(_client);
-  } else if (!_messageQueue.empty() && _messageQueue.front().betweenFrames() && webSocketSendFrameWindow(_client)) {
+  } else if (!_messageQueue.empty() && _messageQueue.front().acked() && webSocketSendFrameWindow(_client)) {
     _messageQueue.front().send(_client);
   }
 }
 
-bool AsyncWebSocketClient::queueIsFull() const {
 #ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lock);
+// Releases _lock taken to send from the queues. A producer that failed to take it meanwhile left _runPending set:
+// run the queue for it, or leave it to whoever holds the lock now, so a new message never waits for the next poll
+void AsyncWebSocketClient::_unlockQueue(std::unique_lock<std::mutex>& lock) {
+  while (true) {
+    lock.unlock();
+    if (!_runPending.load() || !lock.try_lock())
+      return;
+    _runPending = false;
+    if (_client && _client->canSend())
+      _runQueue();
+  }
+}
 #endif
-  return (_messageQueue.size() >= WS_MAX_QUEUED_MESSAGES) || (_status != WS_CONNECTED);
+
+bool AsyncWebSocketClient::queueIsFull() const {
+  return _messageQueue.full() || (_status != WS_CONNECTED);
 }
 
 size_t AsyncWebSocketClient::queueLen() const {
-#ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lock);
-#endif
   return _messageQueue.size();
 }
 
 bool AsyncWebSocketClient::canSend() const {
-#ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lock);
-#endif
-  return _messageQueue.size() < WS_MAX_QUEUED_MESSAGES;
+  return !_messageQueue.full();
 }
 
 bool AsyncWebSocketClient::_queueControl(uint8_t opcode, const uint8_t* data, size_t len, bool mask) {
@@ -395,26 +446,33 @@ bool AsyncWebSocketClient::_queueControl(uint8_t opcode, const uint8_t* data, si
     return false;
 
 #ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lock);
+  std::unique_lock<std::mutex> lock(_lock);
 #endif
 
   _controlQueue.emplace_back(opcode, data, len, mask);
 
   if (_client && _client->canSend())
     _runQueue();
+#ifdef ESP32
+  _unlockQueue(lock);
+#endif
 
   return true;
 }
 
-bool AsyncWebSocketClient::_queueMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode, bool mask) {
+bool AsyncWebSocketClient::_queueMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode, bool mask, bool framed) {
   if (!_client || buffer->size() == 0 || _status != WS_CONNECTED)
     return false;
 
+  bool queued;
+  {
 #ifdef ESP32
-  std::lock_guard<std::mutex> lock(_lock);
+    std::lock_guard<std::mutex> lock(_lockmq);
 #endif
+    queued = _messageQueue.emplace_back(buffer, opcode, mask, framed);
+  }
 
-  if (_messageQueue.size() >= WS_MAX_QUEUED_MESSAGES) {
+  if (!queued) {
     if (closeWhenFull) {
       _status = WS_DISCONNECTED;
 
@@ -438,10 +496,20 @@ bool AsyncWebSocketClient::_queueMessage(AsyncWebSocketSharedBuffer buffer, uint
     return false;
   }
 
-  _messageQueue.emplace_back(buffer, opcode, mask);
-
-  if (_client && _client->canSend())
+  if (_client && _client->canSend()) {
+#ifdef ESP32
+    // never wait for the network task: if it is sending from the queue, it runs it again for this message on release
+    _runPending = true;
+    std::unique_lock<std::mutex> lock(_lock, std::try_to_lock);
+    if (lock.owns_lock()) {
+      _runPending = false;
+      _runQueue();
+      _unlockQueue(lock);
+    }
+#else
     _runQueue();
+#endif
+  }
 
   return true;
 }
@@ -475,6 +543,14 @@ void AsyncWebSocketClient::close(uint16_t code, const char* message) {
   _queueControl(WS_DISCONNECT);
 }
 
+bool AsyncWebSocketClient::subscribe(const String& topic) {
+  return _server->subscribe(_clientId, topic);
+}
+
+bool AsyncWebSocketClient::unsubscribe(const String& topic) {
+  return _server->unsubscribe(_clientId, topic);
+}
+
 bool AsyncWebSocketClient::ping(const uint8_t* data, size_t len) {
   return _status == WS_CONNECTED && _queueControl(WS_PING, data, len);
 }
@@ -496,6 +572,38 @@ void AsyncWebSocketClient::_onDisconnect() {
   _client = nullptr;
 }
 
+// Size of the frame header starting with these 2 bytes
+static size_t __ws_header_length(const uint8_t* header) {
+  size_t len = 2;
+  if ((header[1] & 0x7F) == 126)
+    len += 2;
+  else if ((header[1] & 0x7F) == 127)
+    len += 8;
+  if (header[1] & 0x80)
+    len += 4;
+  return len;
+}
+
+typedef uint32_t __attribute__((__may_alias__)) ws_word_t;
+
+// XOR the payload with the frame mask a word at a time, `index` being the offset of data[0] in the payload
+static void __ws_unmask(uint8_t* data, size_t len, const uint8_t* mask, uint64_t index) {
+  size_t i = 0;
+  // bytes before the first aligned word
+  for (; i < len && ((uintptr_t)(data + i) & (sizeof(ws_word_t) - 1)); i++)
+    data[i] ^= mask[(index + i) & 3];
+  // the mask rotated to start at data[i]
+  uint8_t rotated[4];
+  for (size_t j = 0; j < 4; j++)
+    rotated[j] = mask[(index + i + j) & 3];
+  ws_word_t word;
+  memcpy(&word, rotated, sizeof(word));
+  for (; i + sizeof(word) <= len; i += sizeof(word))
+    *(ws_word_t*)(data + i) ^= word;
+  for (; i < len; i++)
+    data[i] ^= mask[(index + i) & 3];
+}
+
 void AsyncWebSocketClient::_onData(void* pbuf, size_t plen) {
   _lastMessageTime = millis();
   uint8_t* data = (uint8_t*)pbuf;
@@ -503,6 +611,22 @@ void AsyncWebSocketClient::_onData(void* pbuf, size_t plen) {
     if (!_pstate) {
       const uint8_t* fdata = data;
 
+      if (_pheaderLength || plen < 2 || plen < __ws_header_length(data)) {
+        // the header continues in the next segment: gather it
+        while (plen && (_pheaderLength < 2 || _pheaderLength < __ws_header_length(_pheader))) {
+          _pheader[_pheaderLength++] = *data++;
+          plen--;
+        }
+        if (_pheaderLength < 2 || _pheaderLength < __ws_header_length(_pheader))
+          return;
+        fdata = _pheader;
+        _pheaderLength = 0;
+      } else {
+        size_t headerLen = __ws_header_length(data);
+        data += headerLen;
+        plen -= headerLen;
+      }
+
       _pinfo.index = 0;
       _pinfo.final = (fdata[0] & 0x80) != 0;
       _pinfo.opcode = fdata[0] & 0x0F;
@@ -513,34 +637,25 @@ void AsyncWebSocketClient::_onData(void* pbuf, size_t plen) {
       // log_d("WS[%" PRIu32 "]: _status = %" PRIu32, _clientId, _status);
       // log_d("WS[%" PRIu32 "]: _pinfo: index: %" PRIu64 ", final: %" PRIu8 ", opcode: %" PRIu8 ", masked: %" PRIu8 ", len: %" PRIu64, _clientId, _pinfo.index, _pinfo.final, _pinfo.opcode, _pinfo.masked, _pinfo.len);
 
-      data += 2;
-      plen -= 2;
-
-      if (_pinfo.len == 126 && plen >= 2) {
-        _pinfo.len = fdata[3] | (uint16_t)(fdata[2]) << 8;
-        data += 2;
-        plen -= 2;
-
-      } else if (_pinfo.len == 127 && plen >= 8) {
-        _pinfo.len = fdata[9] | (uint16_t)(fdata[8]) << 8 | (uint32_t)(fdata[7]) << 16 | (uint32_t)(fdata[6]) << 24 | (uint64_t)(fdata[5]) << 32 | (uint64_t)(fdata[4]) << 40 | (uint64_t)(fdata[3]) << 48 | (uint64_t)(fdata[2]) << 56;
-        data += 8;
-        plen -= 8;
+      fdata += 2;
+      if (_pinfo.len == 126) {
+        _pinfo.len = fdata[1] | (uint16_t)(fdata[0]) << 8;
+        fdata += 2;
+      } else if (_pinfo.len == 127) {
+        _pinfo.len = fdata[7] | (uint16_t)(fdata[6]) << 8 | (uint32_t)(fdata[5]) << 16 | (uint32_t)(fdata[4]) << 24 | (uint64_t)(fdata[3]) << 32 | (uint64_t)(fdata[2]) << 40 | (uint64_t)(fdata[1]) << 48 | (uint64_t)(fdata[0]) << 56;
+        fdata += 8;
       }
 
-      if (_pinfo.masked && plen >= 4) { // if ws.close() is called, Safari sends a close frame with plen 2 and masked bit set. We must not decrement plen which is already 0.
-        memcpy(_pinfo.mask, data, 4);
-        data += 4;
-        plen -= 4;
-      }
+      // a masked frame always carries the mask, even with no payload (Safari sends it in its own segment on close)
+      if (_pinfo.masked)
+        memcpy(_pinfo.mask, fdata, 4);
     }
 
     const size_t datalen = std::min((size_t)(_pinfo.len - _pinfo.index), plen);
     const auto datalast = data[datalen];
 
-    if (_pinfo.masked) {
-      for (size_t i = 0; i < datalen; i++)
-        data[i] ^= _pinfo.mask[(_pinfo.index + i) % 4];
-    }
+    if (_pinfo.masked)
+      __ws_unmask(data, datalen, _pinfo.mask, _pinfo.index);
 
     if ((datalen + _pinfo.index) < _pinfo.len) {
       _pstate = 1;
@@ -780,6 +895,7 @@ void AsyncWebSocket::_handleEvent(AsyncWebSocketClient* client, AwsEventType typ
 
 AsyncWebSocketClient* AsyncWebSocket::_newClient(AsyncWebServerRequest* request) {
   _clients.emplace_back(request, this);
+  _clientsById[_clients.back().id()] = &_clients.back();
   _handleEvent(&_clients.back(), WS_EVT_CONNECT, request, NULL, 0);
   return &_clients.back();
 }
@@ -789,10 +905,10 @@ bool AsyncWebSocket::availableForWriteAll() {
 }
 
 bool AsyncWebSocket::availableForWrite(uint32_t id) {
-  const auto iter = std::find_if(std::begin(_clients), std::end(_clients), [id](const AsyncWebSocketClient& c) { return c.id() == id; });
-  if (iter == std::end(_clients))
+  const auto iter = _clientsById.find(id);
+  if (iter == _clientsById.end())
     return true;
-  return !iter->queueIsFull();
+  return !iter->second->queueIsFull();
 }
 
 size_t AsyncWebSocket::count() const {
@@ -800,11 +916,11 @@ size_t AsyncWebSocket::count() const {
 }
 
 AsyncWebSocketClient* AsyncWebSocket::client(uint32_t id) {
-  const auto iter = std::find_if(_clients.begin(), _clients.end(), [id](const AsyncWebSocketClient& c) { return c.id() == id && c.status() == WS_CONNECTED; });
-  if (iter == std::end(_clients))
+  const auto iter = _clientsById.find(id);
+  if (iter == _clientsById.end() || iter->second->status() != WS_CONNECTED)
     return nullptr;
 
-  return &(*iter);
+  return iter->second;
 }
 
 void AsyncWebSocket::close(uint32_t id, uint16_t code, const char* message) {
@@ -823,9 +939,11 @@ void AsyncWebSocket::cleanupClients(uint16_t maxClients) {
     _clients.front().close();
 
   for (auto iter = std::begin(_clients); iter != std::end(_clients);) {
-    if (iter->shouldBeDeleted())
+    if (iter->shouldBeDeleted()) {
+      unsubscribeAll(iter->id());
+      _clientsById.erase(iter->id());
       iter = _clients.erase(iter);
-    else
+    } else
       iter++;
   }
 }
@@ -897,7 +1015,7 @@ bool AsyncWebSocket::text(uint32_t id, AsyncWebSocketSharedBuffer buffer) {
 }
 
 AsyncWebSocket::SendStatus AsyncWebSocket::textAll(const uint8_t* message, size_t len) {
-  return textAll(makeSharedBuffer(message, len));
+  return _sendAll(WS_TEXT, message, len);
 }
 AsyncWebSocket::SendStatus AsyncWebSocket::textAll(const char* message, size_t len) {
   return textAll((const uint8_t*)message, len);
@@ -940,14 +1058,7 @@ AsyncWebSocket::SendStatus AsyncWebSocket::textAll(AsyncWebSocketMessageBuffer*
 }
 
 AsyncWebSocket::SendStatus AsyncWebSocket::textAll(AsyncWebSocketSharedBuffer buffer) {
-  size_t hit = 0;
-  size_t miss = 0;
-  for (auto& c : _clients)
-    if (c.status() == WS_CONNECTED && c.text(buffer))
-      hit++;
-    else
-      miss++;
-  return hit == 0 ? DISCARDED : (miss == 0 ? ENQUEUED : PARTIALLY_ENQUEUED);
+  return buffer ? _sendAll(WS_TEXT, buffer->data(), buffer->size()) : DISCARDED;
 }
 
 bool AsyncWebSocket::binary(uint32_t id, const uint8_t* message, size_t len) {
@@ -992,7 +1103,7 @@ bool AsyncWebSocket::binary(uint32_t id, AsyncWebSocketSharedBuffer buffer) {
 }
 
 AsyncWebSocket::SendStatus AsyncWebSocket::binaryAll(const uint8_t* message, size_t len) {
-  return binaryAll(makeSharedBuffer(message, len));
+  return _sendAll(WS_BINARY, message, len);
 }
 AsyncWebSocket::SendStatus AsyncWebSocket::binaryAll(const char* message, size_t len) {
   return binaryAll((const uint8_t*)message, len);
@@ -1027,10 +1138,78 @@ AsyncWebSocket::SendStatus AsyncWebSocket::binaryAll(AsyncWebSocketMessageBuffer
   return status;
 }
 AsyncWebSocket::SendStatus AsyncWebSocket::binaryAll(AsyncWebSocketSharedBuffer buffer) {
+  return buffer ? _sendAll(WS_BINARY, buffer->data(), buffer->size()) : DISCARDED;
+}
+
+// Frame the message once and queue the same frame on every client
+AsyncWebSocket::SendStatus AsyncWebSocket::_sendAll(uint8_t opcode, const uint8_t* message, size_t len) {
+  if (!len || _clients.empty())
+    return DISCARDED;
+  AsyncWebSocketSharedBuffer frame = __ws_frame(opcode, message, len);
   size_t hit = 0;
   size_t miss = 0;
   for (auto& c : _clients)
-    if (c.status() == WS_CONNECTED && c.binary(buffer))
+    if (c.status() == WS_CONNECTED && c._queueMessage(frame, opcode, false, true))
+      hit++;
+    else
+      miss++;
+  return hit == 0 ? DISCARDED : (miss == 0 ? ENQUEUED : PARTIALLY_ENQUEUED);
+}
+
+bool AsyncWebSocket::subscribe(uint32_t id, const String& topic) {
+  AsyncWebSocketClient* c = client(id);
+  if (!c || !topic.length())
+    return false;
+  auto& subscribers = _topics[topic];
+  if (std::find(subscribers.begin(), subscribers.end(), c) == subscribers.end())
+    subscribers.push_back(c);
+  return true;
+}
+
+bool AsyncWebSocket::unsubscribe(uint32_t id, const String& topic) {
+  const auto byId = _clientsById.find(id);
+  const auto iter = _topics.find(topic);
+  if (byId == _clientsById.end() || iter == _topics.end())
+    return false;
+  auto& subscribers = iter->second;
+  const auto entry = std::find(subscribers.begin(), subscribers.end(), byId->second);
+  if (entry == subscribers.end())
+    return false;
+  subscribers.erase(entry);
+  if (subscribers.empty())
+    _topics.erase(iter);
+  return true;
+}
+
+void AsyncWebSocket::unsubscribeAll(uint32_t id) {
+  const auto byId = _clientsById.find(id);
+  if (byId == _clientsById.end())
+    return;
+  for (auto iter = _topics.begin(); iter != _topics.end();) {
+    auto& subscribers = iter->second;
+    subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), byId->second), subscribers.end());
+    if (subscribers.empty())
+      iter = _topics.erase(iter);
+    else
+      iter++;
+  }
+}
+
+size_t AsyncWebSocket::subscribers(const String& topic) const {
+  const auto iter = _topics.find(topic);
+  return iter == _topics.end() ? 0 : iter->second.size();
+}
+
+// Frame the message once and queue it on the topic's subscribers only
+AsyncWebSocket::SendStatus AsyncWebSocket::publish(const String& topic, const uint8_t* message, size_t len, uint8_t opcode) {
+  const auto iter = _topics.find(topic);
+  if (!len || iter == _topics.end())
+    return DISCARDED;
+  AsyncWebSocketSharedBuffer frame = __ws_frame(opcode, message, len);
+  size_t hit = 0;
+  size_t miss = 0;
+  for (auto c : iter->second)
+    if (c->status() == WS_CONNECTED && c->_queueMessage(frame, opcode, false, true))
       hit++;
     else
       miss++;
@@ -1135,6 +1314,12 @@ bool AsyncWebSocket::canHandle(AsyncWebServerRequest* request) const {
   return _enabled && request->isWebSocketUpgrade() && request->url().equals(_url);
 }
 
+WebRouteMatch AsyncWebSocket::routeKey(String& uri, WebRequestMethodComposite& methods) const {
+  uri = _url;
+  methods = HTTP_GET;
+  return ROUTE_EXACT;
+}
+
 void AsyncWebSocket::handleRequest(AsyncWebServerRequest* request) {
   if (!request->hasHeader(WS_STR_VERSION) || !request->hasHeader(WS_STR_KEY)) {
     request->send(400);
@@ -40,9 +40,12 @@
   #endif
 #endif
 
+#include "AsyncSPSCQueue.h"
 #include <ESPAsyncWebServer.h>
 
+#include <map>
 #include <memory>
+#include <unordered_map>
 
 #ifdef ESP8266
   #include <Hash.h>
@@ -131,44 +134,57 @@ class AsyncWebSocketMessage {
     AsyncWebSocketSharedBuffer _WSbuffer;
     uint8_t _opcode{WS_TEXT};
     bool _mask{false};
+    // the buffer already holds a complete frame (header and payload), sent as is
+    bool _framed{false};
     AwsMessageStatus _status{WS_MSG_ERROR};
     size_t _sent{};
     size_t _ack{};
     size_t _acked{};
 
   public:
-    AsyncWebSocketMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode = WS_TEXT, bool mask = false);
+    AsyncWebSocketMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode = WS_TEXT, bool mask = false, bool framed = false);
 
     bool finished() const { return _status != WS_MSG_SENDING; }
-    bool betweenFrames() const { return _acked == _ack; }
+    bool acked() const { return _acked == _ack; }
+    bool betweenFrames() const { return _acked == _ack && (!_framed || _sent == 0 || _sent == _WSbuffer->size()); }
 
     void ack(size_t len, uint32_t time);
     size_t send(AsyncClient* client);
 };
 
 class AsyncWebSocketClient {
+    friend AsyncWebSocket;
+
   private:
     AsyncClient* _client;
     AsyncWebSocket* _server;
     uint32_t _clientId;
     AwsClientStatus _status;
 #ifdef ESP32
-    mutable std::mutex _lock;
+    mutable std::mutex _lock;   // control queue, and whoever is sending from the queues
+    mutable std::mutex _lockmq; // between message producers only, never taken by the network task
+    std::atomic<bool> _runPending{false}; // a producer found _lock taken: its holder runs the queue again
 #endif
     std::deque<AsyncWebSocketControl> _controlQueue;
-    std::deque<AsyncWebSocketMessage> _messageQueue;
+    AsyncSPSCQueue<AsyncWebSocketMessage, WS_MAX_QUEUED_MESSAGES> _messageQueue;
     bool closeWhenFull = true;
 
     uint8_t _pstate;
     AwsFrameInfo _pinfo;
+    // frame header split across TCP segments: 2 bytes, up to 8 of extended length and the 4 byte mask
+    uint8_t _pheader[14];
+    uint8_t _pheaderLength;
 
     uint32_t _lastMessageTime;
     uint32_t _keepAlivePeriod;
 
     bool _queueControl(uint8_t opcode, const uint8_t* data = NULL, size_t len = 0, bool mask = false);
-    bool _queueMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode = WS_TEXT, bool mask = false);
+    bool _queueMessage(AsyncWebSocketSharedBuffer buffer, uint8_t opcode = WS_TEXT, bool mask = false, bool framed = false);
     void _runQueue();
     void _clearQueue();
+#ifdef ESP32
+    void _unlockQueue(std::unique_lock<std::mutex>& lock);
+#endif
 
   public:
     void* _tempObject;
@@ -215,6 +231,10 @@ class AsyncWebSocketClient {
     void close(uint16_t code = 0, const char* message = NULL);
     bool ping(const uint8_t* data = NULL, size_t len = 0);
 
+    // topics this client receives AsyncWebSocket::publish() messages for
+    bool subscribe(const String& topic);
+    bool unsubscribe(const String& topic);
+
     // set auto-ping period in seconds. disabled if zero (default)
     void keepAlivePeriod(uint16_t seconds) {
       _keepAlivePeriod = seconds * 1000;
@@ -269,6 +289,8 @@ class AsyncWebSocket : public AsyncWebHandler {
   private:
     String _url;
     std::list<AsyncWebSocketClient> _clients;
+    std::unordered_map<uint32_t, AsyncWebSocketClient*> _clientsById;
+    std::map<String, std::vector<AsyncWebSocketClient*>> _topics;
     uint32_t _cNextId;
     AwsEventHandler _eventHandler{nullptr};
     AwsHandshakeHandler _handshakeHandler;
@@ -332,6 +354,15 @@ class AsyncWebSocket : public AsyncWebHandler {
     SendStatus binaryAll(AsyncWebSocketMessageBuffer* buffer);
     SendStatus binaryAll(AsyncWebSocketSharedBuffer buffer);
 
+    // topics, e.g. "door/1/events": publish() only reaches the clients subscribed to it
+    bool subscribe(uint32_t id, const String& topic);
+    bool unsubscribe(uint32_t id, const String& topic);
+    void unsubscribeAll(uint32_t id);
+    size_t subscribers(const String& topic) const;
+    SendStatus publish(const String& topic, const uint8_t* message, size_t len, uint8_t opcode = WS_TEXT);
+    SendStatus publish(const String& topic, const char* message) { return publish(topic, (const uint8_t*)message, strlen(message)); }
+    SendStatus publish(const String& topic, const String& message) { return publish(topic, (const uint8_t*)message.c_str(), message.length()); }
+
     size_t printf(uint32_t id, const char* format, ...) __attribute__((format(printf, 3, 4)));
     size_t printfAll(const char* format, ...) __attribute__((format(printf, 2, 3)));
 
@@ -351,7 +382,9 @@ class AsyncWebSocket : public AsyncWebHandler {
     uint32_t _getNextId() { return _cNextId++; }
     AsyncWebSocketClient* _newClient(AsyncWebServerRequest* request);
     void _handleEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    SendStatus _sendAll(uint8_t opcode, const uint8_t* message, size_t len);
     bool canHandle(AsyncWebServerRequest* request) const override final;
+    WebRouteMatch routeKey(String& uri, WebRequestMethodComposite& methods) const override final;
     void handleRequest(AsyncWebServerRequest* request) override final;
 
     //  messagebuffer functions/objects.
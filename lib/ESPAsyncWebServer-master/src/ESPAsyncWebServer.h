@@ -63,6 +63,8 @@
 class AsyncWebServer;
 class AsyncWebServerRequest;
 class AsyncWebServerResponse;
+class AsyncWebResponseHead;
+class AsyncWebTemplate;
 class AsyncWebHeader;
 class AsyncWebParameter;
 class AsyncWebRewrite;
@@ -106,6 +108,36 @@ namespace fs {
 #define RESPONSE_TRY_AGAIN          0xFFFFFFFF
 #define RESPONSE_STREAM_BUFFER_SIZE 1460
 
+// Persistent connections: seconds a connection may wait for its next request, requests served
+// on one connection (0 disables keep-alive) and bytes of pipelined requests buffered meanwhile
+#ifndef ASYNCWEBSERVER_KEEPALIVE_TIMEOUT
+  #define ASYNCWEBSERVER_KEEPALIVE_TIMEOUT 5
+#endif
+#ifndef ASYNCWEBSERVER_KEEPALIVE_MAX_REQUESTS
+  #define ASYNCWEBSERVER_KEEPALIVE_MAX_REQUESTS 100
+#endif
+#ifndef ASYNCWEBSERVER_PIPELINE_SIZE
+  #define ASYNCWEBSERVER_PIPELINE_SIZE 2048
+#endif
+
+// Streamed responses fill one of these shared buffers per ack (one lwIP send buffer each)
+#ifndef ASYNCWEBSERVER_SEND_BUFFER_SIZE
+  #define ASYNCWEBSERVER_SEND_BUFFER_SIZE 5744
+#endif
+#ifndef ASYNCWEBSERVER_SEND_BUFFERS
+  #define ASYNCWEBSERVER_SEND_BUFFERS 2
+#endif
+
+// Request paths whose file lookup each static handler remembers
+#ifndef ASYNCWEBSERVER_STATIC_CACHE_SIZE
+  #define ASYNCWEBSERVER_STATIC_CACHE_SIZE 8
+#endif
+
+// Client buckets a rate limit middleware keeps, the least recently seen one is reused when full
+#ifndef ASYNCWEBSERVER_RATE_LIMIT_CLIENTS
+  #define ASYNCWEBSERVER_RATE_LIMIT_CLIENTS 16
+#endif
+
 typedef uint8_t WebRequestMethodComposite;
 typedef std::function<void(void)> ArDisconnectHandler;
 
@@ -152,6 +184,128 @@ class AsyncWebHeader {
     String toString() const;
 };
 
+/*
+ * ARENA :: Bump allocator owned by each Request, everything in it is released at once with the Request
+ * */
+
+#ifndef ASYNCWEBSERVER_ARENA_BLOCK_SIZE
+  #define ASYNCWEBSERVER_ARENA_BLOCK_SIZE 512
+#endif
+
+// Largest urlencoded body that is parsed into params, bigger ones are answered with 413
+#ifndef ASYNCWEBSERVER_MAX_FORM_SIZE
+  #define ASYNCWEBSERVER_MAX_FORM_SIZE 16384
+#endif
+
+class AsyncWebRequestArena {
+  private:
+    struct Block {
+        Block* next;
+        size_t size;
+        size_t used;
+    };
+    Block* _blocks = nullptr;
+    size_t _blockCount = 0;
+    size_t _firstBlockSize = ASYNCWEBSERVER_ARENA_BLOCK_SIZE;
+
+  public:
+    AsyncWebRequestArena() {}
+    ~AsyncWebRequestArena() { release(); }
+    AsyncWebRequestArena(const AsyncWebRequestArena&) = delete;
+    AsyncWebRequestArena& operator=(const AsyncWebRequestArena&) = delete;
+
+    // Size of the first block, ignored once something was allocated
+    void reserve(size_t size);
+    void* allocate(size_t size, size_t align = alignof(void*));
+    // NUL terminated copy of data
+    char* copy(const char* data, size_t len);
+    void release();
+    size_t blocks() const { return _blockCount; }
+};
+
+// Flat array of trivially copyable items living in a request arena
+template <typename T>
+class AsyncWebArenaArray {
+  private:
+    T* _items = nullptr;
+    size_t _size = 0;
+    size_t _capacity = 0;
+
+  public:
+    bool push_back(AsyncWebRequestArena& arena, const T& item) {
+      if (_size == _capacity) {
+        // the old items stay in the arena until the request is freed
+        size_t capacity = _capacity ? _capacity * 2 : 8;
+        T* items = (T*)arena.allocate(capacity * sizeof(T), alignof(T));
+        if (!items)
+          return false;
+        if (_size)
+          memcpy(items, _items, _size * sizeof(T));
+        _items = items;
+        _capacity = capacity;
+      }
+      _items[_size++] = item;
+      return true;
+    }
+    void erase(size_t i) {
+      memmove(_items + i, _items + i + 1, (--_size - i) * sizeof(T));
+    }
+    void clear() { _size = 0; }
+    size_t size() const { return _size; }
+    T& operator[](size_t i) { return _items[i]; }
+    const T& operator[](size_t i) const { return _items[i]; }
+    T* begin() { return _items; }
+    T* end() { return _items + _size; }
+    const T* begin() const { return _items; }
+    const T* end() const { return _items + _size; }
+};
+
+// Request headers that get an interned id while parsing, so that looking them up doesn't walk the headers.
+// The ids come from a perfect hash over these names, see AsyncWebServerRequest::_headerId().
+typedef enum : uint8_t {
+  HDR_UNKNOWN = 0,
+  HDR_ACCEPT,
+  HDR_ACCEPT_ENCODING,
+  HDR_AUTHORIZATION,
+  HDR_CACHE_CONTROL,
+  HDR_CONNECTION,
+  HDR_CONTENT_LENGTH,
+  HDR_CONTENT_TYPE,
+  HDR_COOKIE,
+  HDR_EXPECT,
+  HDR_HOST,
+  HDR_IF_MODIFIED_SINCE,
+  HDR_IF_NONE_MATCH,
+  HDR_IF_RANGE,
+  HDR_LAST_EVENT_ID,
+  HDR_ORIGIN,
+  HDR_RANGE,
+  HDR_SEC_WS_KEY,
+  HDR_SEC_WS_PROTOCOL,
+  HDR_SEC_WS_VERSION,
+  HDR_TRANSFER_ENCODING,
+  HDR_UPGRADE,
+  HDR_MAX
+} WebHeaderId;
+
+// Parsed header: name and value point into the request arena.
+// The AsyncWebHeader is only built (in the arena as well) when the header is read through the String API.
+struct AsyncWebHeaderView {
+    const char* name;
+    const char* value;
+    AsyncWebHeader* header;
+    WebHeaderId id;
+};
+
+struct AsyncWebParameterView {
+    const char* name;
+    const char* value;
+    size_t size;
+    bool isForm;
+    bool isFile;
+    AsyncWebParameter* param;
+};
+
 /*
  * REQUEST :: Each incoming Client is wrapped inside a Request and both live together until disconnect
  * */
@@ -175,12 +329,15 @@ typedef enum {
 
 typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
 typedef std::function<String(const String&)> AwsTemplateProcessor;
+// Writes the value of placeholder `id` of an AsyncWebTemplate straight into the response
+typedef std::function<void(size_t id, Print& out)> AwsTemplateRenderer;
 
 class AsyncWebServerRequest {
     using File = fs::File;
     using FS = fs::FS;
     friend class AsyncWebServer;
     friend class AsyncCallbackWebHandler;
+    friend class AsyncWebServerResponse;
 
   private:
     AsyncClient* _client;
@@ -195,6 +352,11 @@ class AsyncWebServerRequest {
     String _temp;
     uint8_t _parseState;
 
+    // start of a request line, header line or form field that continues in the next segment, in _arena
+    char* _partialLine;
+    size_t _partialLineLength;
+    size_t _partialLineCapacity;
+
     uint8_t _version;
     WebRequestMethodComposite _method;
     String _url;
@@ -210,14 +372,27 @@ class AsyncWebServerRequest {
     size_t _contentLength;
     size_t _parsedLength;
 
-    std::list<AsyncWebHeader> _headers;
-    std::list<AsyncWebParameter> _params;
+    bool _keepAlive;            // the client lets the connection stay open after the response
+    size_t _connectionRequests; // requests answered before this one on the same connection
+    uint32_t _idleSince;        // millis() when the connection started waiting for this request
+    uint8_t* _pipelined;        // data received after this request, for the next one
+    size_t _pipelinedLength;
+
+    // headers and params live in _arena, see AsyncWebHeaderView
+    mutable AsyncWebRequestArena _arena;
+    mutable AsyncWebArenaArray<AsyncWebHeaderView> _headers;
+    mutable AsyncWebArenaArray<AsyncWebParameterView> _params;
+    mutable std::list<AsyncWebHeader> _headerList; // returned by getHeaders(), built on first call
+    uint16_t _knownHeaders[HDR_MAX];               // index + 1 of the first header with this id, 0 if none
     std::vector<String> _pathParams;
 
     std::unordered_map<const char*, String, std::hash<const char*>, std::equal_to<const char*>> _attributes;
 
     uint8_t _multiParseState;
     uint8_t _boundaryPosition;
+    const uint8_t* _delimiter;  // "\r\n--" + _boundary, in _arena
+    const uint8_t* _delimiterSkip; // Horspool shift table for _delimiter, in _arena
+    size_t _delimiterLength;
     size_t _itemStartIndex;
     size_t _itemSize;
     String _itemName;
@@ -234,18 +409,37 @@ class AsyncWebServerRequest {
     void _onTimeout(uint32_t time);
     void _onDisconnect();
     void _onData(void* buf, size_t len);
+    void _runRequest(int code = 0);
+    void _endResponse();
+    void _pipeline(const void* data, size_t len);
 
     void _addPathParam(const char* param);
-
-    bool _parseReqHead();
-    bool _parseReqHeader();
-    void _parseLine();
-    void _parsePlainPostChar(uint8_t data);
+    void _addHeader(const char* name, size_t nameLen, const char* value, size_t valueLen);
+    void _addParam(const char* name, size_t nameLen, const char* value, size_t valueLen, bool decode, bool form = false, bool file = false, size_t size = 0);
+    const AsyncWebHeader* _headerAt(size_t i) const;
+    int _findHeader(const char* name) const;
+    void _indexHeaders();
+    static WebHeaderId _headerId(const char* name, size_t len);
+    const AsyncWebParameter* _paramAt(size_t i) const;
+    void _freeHeader(AsyncWebHeaderView& h);
+    void _freeParams();
+    static size_t _urlDecodeInPlace(char* text, size_t len);
+
+    bool _parseReqHead(const char* line, size_t len);
+    bool _parseReqHeader(const char* line, size_t len);
+    void _parseLine(const char* line, size_t len);
+    bool _appendPartialLine(const char* data, size_t len);
+    void _parsePlainPost(const char* data, size_t len);
+    void _addPlainPostField(const char* field, size_t len);
+    void _parseMultipartPost(uint8_t* data, size_t len);
     void _parseMultipartPostByte(uint8_t data, bool last);
-    void _addGetParams(const String& params);
+    size_t _multipartContentLength(const uint8_t* data, size_t len) const;
+    void _addGetParams(const String& params) { _addGetParams(params.c_str(), params.length()); }
+    void _addGetParams(const char* params, size_t len);
 
     void _handleUploadStart();
     void _handleUploadByte(uint8_t data, bool last);
+    void _handleUploadBytes(uint8_t* data, size_t len, bool last);
     void _handleUploadEnd();
 
   public:
@@ -304,6 +498,16 @@ class AsyncWebServerRequest {
     void redirect(const char* url, int code = 302);
     void redirect(const String& url, int code = 302) { return redirect(url.c_str(), code); };
 
+    // Conditional GET: true when the client's If-None-Match names `etag` (a quoted entity tag),
+    // or, without If-None-Match, its If-Modified-Since is `lastModified`
+    bool notModified(const String& etag, const String& lastModified = emptyString) const;
+    // Answers 304 Not Modified when notModified(etag), before the handler builds the body:
+    //   String etag = AsyncWebServerResponse::versionETag(revision);
+    //   if (request->sendNotModified(etag))
+    //     return;
+    // and the full response carries the same ETag header
+    bool sendNotModified(const String& etag);
+
     void send(AsyncWebServerResponse* response);
     AsyncWebServerResponse* getResponse() const { return _response; }
 
@@ -314,6 +518,11 @@ class AsyncWebServerRequest {
     void send(int code, const char* contentType, const uint8_t* content, size_t len, AwsTemplateProcessor callback = nullptr) { send(beginResponse(code, contentType, content, len, callback)); }
     void send(int code, const String& contentType, const uint8_t* content, size_t len, AwsTemplateProcessor callback = nullptr) { send(beginResponse(code, contentType, content, len, callback)); }
 
+    void send(const AsyncWebResponseHead& head, const char* content = asyncsrv::empty) { send(beginResponse(head, content)); }
+    void send(const AsyncWebResponseHead& head, const String& content) { send(beginResponse(head, content)); }
+    void send(int code, const char* contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer = nullptr) { send(beginResponse(code, contentType, tpl, renderer)); }
+    void send(int code, const String& contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer = nullptr) { send(beginResponse(code, contentType.c_str(), tpl, renderer)); }
+
     void send(FS& fs, const String& path, const char* contentType = asyncsrv::empty, bool download = false, AwsTemplateProcessor callback = nullptr) {
       if (fs.exists(path) || (!download && fs.exists(path + asyncsrv::T__gz))) {
         send(beginResponse(fs, path, contentType, download, callback));
@@ -361,6 +570,10 @@ class AsyncWebServerRequest {
     AsyncWebServerResponse* beginResponse(int code, const String& contentType, const String& content, AwsTemplateProcessor callback = nullptr) { return beginResponse(code, contentType.c_str(), content.c_str(), callback); }
 
     AsyncWebServerResponse* beginResponse(int code, const char* contentType, const uint8_t* content, size_t len, AwsTemplateProcessor callback = nullptr);
+    AsyncWebServerResponse* beginResponse(const AsyncWebResponseHead& head, const char* content = asyncsrv::empty);
+    AsyncWebServerResponse* beginResponse(const AsyncWebResponseHead& head, const String& content);
+    AsyncWebServerResponse* beginResponse(int code, const char* contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer = nullptr);
+    AsyncWebServerResponse* beginResponse(int code, const String& contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer = nullptr) { return beginResponse(code, contentType.c_str(), tpl, renderer); }
     AsyncWebServerResponse* beginResponse(int code, const String& contentType, const uint8_t* content, size_t len, AwsTemplateProcessor callback = nullptr) { return beginResponse(code, contentType.c_str(), content, len, callback); }
 
     AsyncWebServerResponse* beginResponse(FS& fs, const String& path, const char* contentType = asyncsrv::empty, bool download = false, AwsTemplateProcessor callback = nullptr);
@@ -462,7 +675,8 @@ class AsyncWebServerRequest {
 
     const AsyncWebHeader* getHeader(size_t num) const;
 
-    const std::list<AsyncWebHeader>& getHeaders() const { return _headers; }
+    // Builds a copy of all the headers as AsyncWebHeader: prefer header() or getHeader() in request handlers
+    const std::list<AsyncWebHeader>& getHeaders() const;
 
     size_t getHeaderNames(std::vector<const char*>& names) const;
 
@@ -470,7 +684,7 @@ class AsyncWebServerRequest {
     // It will free the memory and prevent the header to be seen during request processing.
     bool removeHeader(const char* name);
     // Remove all request headers.
-    void removeHeaders() { _headers.clear(); }
+    void removeHeaders();
 
     size_t params() const; // get arguments count
     bool hasParam(const char* name, bool post = false, bool file = false) const;
@@ -554,7 +768,7 @@ class AsyncMiddlewareChain {
     void _runChain(AsyncWebServerRequest* request, ArMiddlewareNext finalizer);
 
   protected:
-    std::list<AsyncMiddleware*> _middlewares;
+    std::vector<AsyncMiddleware*> _middlewares;
 };
 
 // AsyncAuthenticationMiddleware is a middleware that checks if the request is authenticated
@@ -674,19 +888,57 @@ class AsyncCorsMiddleware : public AsyncMiddleware {
 };
 
 // Rate limit Middleware
+// Each client IP gets a token bucket per route class: up to maxRequests in a burst, refilled evenly over the window.
+// Buckets live in a fixed table of ASYNCWEBSERVER_RATE_LIMIT_CLIENTS entries, the least recently used is evicted.
 class AsyncRateLimitMiddleware : public AsyncMiddleware {
   public:
-    void setMaxRequests(size_t maxRequests) { _maxRequests = maxRequests; }
-    void setWindowSize(uint32_t seconds) { _windowSizeMillis = seconds * 1000; }
+    AsyncRateLimitMiddleware();
+
+    void setMaxRequests(size_t maxRequests) { _limits[0].maxRequests = maxRequests; }
+    void setWindowSize(uint32_t seconds) { _limits[0].windowMillis = seconds * 1000; }
+    // separate limit for the urls starting with prefix, e.g. "/login"; the first matching prefix wins
+    void addRouteLimit(const char* prefix, size_t maxRequests, uint32_t windowSeconds);
 
+    // one bucket shared by every caller
     bool isRequestAllowed(uint32_t& retryAfterSeconds);
+    // the bucket of the request's client IP and route class
+    bool isRequestAllowed(AsyncWebServerRequest* request, uint32_t& retryAfterSeconds);
 
     void run(AsyncWebServerRequest* request, ArMiddlewareNext next);
 
   private:
-    size_t _maxRequests = 0;
-    uint32_t _windowSizeMillis = 0;
-    std::list<uint32_t> _requestTimes;
+    static constexpr uint16_t NONE = 0xFFFF;
+    static constexpr size_t HASH_SIZE = 2 * ASYNCWEBSERVER_RATE_LIMIT_CLIENTS;
+
+    struct Limit {
+        String prefix;
+        size_t maxRequests;
+        uint32_t windowMillis;
+    };
+    // tokens are counted in 1/windowMillis of a request: a request costs windowMillis, each millisecond adds maxRequests,
+    // so maxRequests * windowMillis must fit in 32 bits
+    struct Bucket {
+        uint32_t ip;
+        uint32_t tokens;
+        uint32_t updated;
+        uint16_t limit;
+        uint16_t next; // hash chain
+        uint16_t newer;
+        uint16_t older;
+    };
+
+    std::vector<Limit> _limits;
+    Bucket _buckets[ASYNCWEBSERVER_RATE_LIMIT_CLIENTS];
+    uint16_t _hash[HASH_SIZE];
+    uint16_t _used = 0;
+    uint16_t _newest = NONE;
+    uint16_t _oldest = NONE;
+
+    static size_t _slot(uint32_t ip, uint16_t limit) { return ((ip ^ ((uint32_t)limit << 24)) * 2654435761u) % HASH_SIZE; }
+    void _unlink(uint16_t i);
+    void _linkNewest(uint16_t i);
+    Bucket& _bucket(uint32_t ip, uint16_t limit);
+    bool _allow(uint32_t ip, uint16_t limit, uint32_t& retryAfterSeconds);
 };
 
 /*
@@ -724,6 +976,14 @@ class AsyncWebRewrite {
  * HANDLER :: One instance can be attached to any Request (done by the Server)
  * */
 
+// How a handler matches the url, used by the server to index its handlers (see AsyncWebRouter)
+typedef enum {
+  ROUTE_NONE,    // not indexed: canHandle() is asked on every request (regex, custom handlers)
+  ROUTE_EXACT,   // url == uri
+  ROUTE_SEGMENT, // url == uri or url starts with uri + "/"
+  ROUTE_PREFIX,  // url starts with uri
+} WebRouteMatch;
+
 class AsyncWebHandler : public AsyncMiddlewareChain {
   protected:
     ArRequestFilterFunction _filter = nullptr;
@@ -741,6 +1001,9 @@ class AsyncWebHandler : public AsyncMiddlewareChain {
     virtual void handleUpload(__unused AsyncWebServerRequest* request, __unused const String& filename, __unused size_t index, __unused uint8_t* data, __unused size_t len, __unused bool final) {}
     virtual void handleBody(__unused AsyncWebServerRequest* request, __unused uint8_t* data, __unused size_t len, __unused size_t index, __unused size_t total) {}
     virtual bool isRequestHandlerTrivial() const { return true; }
+    // Fills uri and methods and returns how this handler matches. Read once when the server builds its route table.
+    // canHandle() is still called on the matching handlers, so the key only has to be as wide as the real match.
+    virtual WebRouteMatch routeKey(__unused String& uri, __unused WebRequestMethodComposite& methods) const { return ROUTE_NONE; }
 };
 
 /*
@@ -769,9 +1032,18 @@ class AsyncWebServerResponse {
     size_t _ackedLength;
     size_t _writtenLength;
     WebResponseState _state;
+    bool _keepAlive;
+    const AsyncWebResponseHead* _frozenHead; // status line and headers assembled beforehand, if any
+
+    // Connection header for the request, keeps the connection open when both sides allow it
+    void _assembleConnection(AsyncWebServerRequest* request);
+    // the response no longer matches its frozen head: take its headers back and assemble normally
+    void _thawHead();
 
   public:
     static const char* responseCodeToString(int code);
+    // strong entity tag for a version of generated content, e.g. a database revision
+    static String versionETag(uint32_t version);
 
   public:
     AsyncWebServerResponse();
@@ -802,11 +1074,66 @@ class AsyncWebServerResponse {
     virtual bool _started() const;
     virtual bool _finished() const;
     virtual bool _failed() const;
+    bool _keepsAlive() const { return _keepAlive; }
     virtual bool _sourceValid() const;
     virtual void _respond(AsyncWebServerRequest* request);
     virtual size_t _ack(AsyncWebServerRequest* request, size_t len, uint32_t time);
 };
 
+/*
+ * RESPONSE HEAD :: Status line and headers assembled once, for responses that always send the same ones
+ * */
+
+class AsyncWebResponseHead {
+    friend class AsyncWebServerResponse;
+
+  private:
+    int _code;
+    String _contentType;
+    std::list<AsyncWebHeader> _headers;
+    mutable String _head;
+
+  public:
+    explicit AsyncWebResponseHead(int code, const char* contentType = asyncsrv::empty);
+    AsyncWebResponseHead(int code, const String& contentType) : AsyncWebResponseHead(code, contentType.c_str()) {}
+    // Content-Length and Connection are set for each response
+    AsyncWebResponseHead& addHeader(const char* name, const char* value);
+    int code() const { return _code; }
+    // "HTTP/1.1 <code> <reason>" and all the headers (default ones included), assembled on first use.
+    // Responses sent with a head keep a pointer to it: it must live as long as the server, usually as a global.
+    const String& head() const;
+};
+
+/*
+ * TEMPLATE :: Page split once into literal text and placeholders, rendered without copying the text
+ * */
+
+class AsyncWebTemplate {
+  public:
+    // literal text, or placeholder `id` when id >= 0
+    struct Segment {
+        const char* data;
+        size_t length;
+        int id;
+    };
+
+    // Placeholders are %NAME%, NAME made of letters, digits and '_', and "%%" is a single '%'.
+    // The text is not copied: it must live as long as the template, usually PROGMEM.
+    explicit AsyncWebTemplate(const char* text) : AsyncWebTemplate(text, strlen(text)) {}
+    AsyncWebTemplate(const char* text, size_t len);
+    // id of placeholder `name`, -1 if the template has none
+    int id(const char* name) const;
+    const String& name(size_t id) const { return _names[id]; }
+    size_t placeholders() const { return _names.size(); }
+    const std::vector<Segment>& segments() const { return _segments; }
+
+  private:
+    std::vector<Segment> _segments;
+    std::vector<String> _names;
+    void _addText(const char* data, size_t len);
+    int _addName(const char* name, size_t len);
+};
+
 /*
  * SERVER :: One instance
  * */
@@ -815,12 +1142,47 @@ typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunc
 typedef std::function<void(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final)> ArUploadHandlerFunction;
 typedef std::function<void(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
 
+// Compiled route table: a radix trie over the handler uris, with the methods of each route as a bitmap.
+// Handlers that cannot be indexed are kept in a fallback list. Candidates from both are tried
+// in registration order, so the first handler that can handle the request still wins.
+class AsyncWebRouter {
+  public:
+    void build(const std::list<std::unique_ptr<AsyncWebHandler>>& handlers);
+    void clear();
+    bool built() const { return _built && _builtVersion == _version; }
+    // a handler's uri or methods changed: every route table is built again on its next request
+    static void invalidate() { _version++; }
+    AsyncWebHandler* find(AsyncWebServerRequest* request) const;
+
+  private:
+    struct Route {
+        AsyncWebHandler* handler;
+        WebRouteMatch match;
+        WebRequestMethodComposite methods;
+    };
+    struct Node {
+        String label; // edge label from the parent node
+        std::vector<uint16_t> children;
+        std::vector<uint16_t> routes; // indexes in _routes, ascending
+    };
+    std::vector<Route> _routes;      // all handlers, in registration order
+    std::vector<Node> _nodes;        // _nodes[0] is the root
+    std::vector<uint16_t> _fallback; // ROUTE_NONE routes, ascending
+    bool _built = false;
+    uint32_t _builtVersion = 0;
+    static uint32_t _version;
+
+    void _insert(const String& uri, uint16_t route);
+    int _next(const String& url, WebRequestMethodComposite method, int after) const;
+};
+
 class AsyncWebServer : public AsyncMiddlewareChain {
   protected:
     AsyncServer _server;
     std::list<std::shared_ptr<AsyncWebRewrite>> _rewrites;
     std::list<std::unique_ptr<AsyncWebHandler>> _handlers;
     AsyncCallbackWebHandler* _catchAllHandler;
+    AsyncWebRouter _router;
 
   public:
     AsyncWebServer(uint16_t port);
@@ -881,6 +1243,7 @@ class AsyncWebServer : public AsyncMiddlewareChain {
     AsyncCallbackWebHandler& on(const char* uri, ArRequestHandlerFunction onRequest) { return on(uri, HTTP_ANY, onRequest); }
     AsyncCallbackWebHandler& on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload = nullptr, ArBodyHandlerFunction onBody = nullptr);
 
+    // File lookups and validators are cached: call AsyncStaticWebHandler::invalidateCache() after changing served files
     AsyncStaticWebHandler& serveStatic(const char* uri, fs::FS& fs, const char* path, const char* cache_control = NULL);
 
     void onNotFound(ArRequestHandlerFunction fn);  // called when handler is not assigned
@@ -39,17 +39,24 @@ bool AsyncMiddlewareChain::removeMiddleware(AsyncMiddleware* middleware) {
 }
 
 void AsyncMiddlewareChain::_runChain(AsyncWebServerRequest* request, ArMiddlewareNext finalizer) {
-  if (!_middlewares.size())
+  if (_middlewares.empty())
     return finalizer();
-  ArMiddlewareNext next;
-  std::list<AsyncMiddleware*>::iterator it = _middlewares.begin();
-  next = [this, &next, &it, request, finalizer]() {
-    if (it == _middlewares.end())
-      return finalizer();
-    AsyncMiddleware* m = *it;
-    it++;
-    return m->run(request, next);
+  // the chain state lives on the stack and `next` only captures a reference to it,
+  // small enough for std::function to store inline: walking the chain does not allocate
+  struct {
+      const std::vector<AsyncMiddleware*>& middlewares;
+      AsyncWebServerRequest* request;
+      ArMiddlewareNext& finalizer;
+      ArMiddlewareNext* next;
+      size_t index;
+  } chain{_middlewares, request, finalizer, nullptr, 0};
+  ArMiddlewareNext next = [&chain]() {
+    if (chain.index == chain.middlewares.size())
+      return chain.finalizer();
+    AsyncMiddleware* m = chain.middlewares[chain.index++];
+    return m->run(chain.request, *chain.next);
   };
+  chain.next = &next;
   return next();
 }
 
@@ -226,27 +233,119 @@ void AsyncCorsMiddleware::run(AsyncWebServerRequest* request, ArMiddlewareNext n
   }
 }
 
-bool AsyncRateLimitMiddleware::isRequestAllowed(uint32_t& retryAfterSeconds) {
-  uint32_t now = millis();
+AsyncRateLimitMiddleware::AsyncRateLimitMiddleware() : _limits{{String(), 0, 0}} {
+  for (size_t i = 0; i < HASH_SIZE; i++)
+    _hash[i] = NONE;
+}
 
-  while (!_requestTimes.empty() && _requestTimes.front() <= now - _windowSizeMillis)
-    _requestTimes.pop_front();
+void AsyncRateLimitMiddleware::addRouteLimit(const char* prefix, size_t maxRequests, uint32_t windowSeconds) {
+  _limits.push_back({prefix, maxRequests, windowSeconds * 1000});
+}
 
-  _requestTimes.push_back(now);
+void AsyncRateLimitMiddleware::_unlink(uint16_t i) {
+  Bucket& b = _buckets[i];
+  if (b.older != NONE)
+    _buckets[b.older].newer = b.newer;
+  else
+    _oldest = b.newer;
+  if (b.newer != NONE)
+    _buckets[b.newer].older = b.older;
+  else
+    _newest = b.older;
+}
 
-  if (_requestTimes.size() > _maxRequests) {
-    _requestTimes.pop_front();
-    retryAfterSeconds = (_windowSizeMillis - (now - _requestTimes.front())) / 1000 + 1;
-    return false;
+void AsyncRateLimitMiddleware::_linkNewest(uint16_t i) {
+  _buckets[i].newer = NONE;
+  _buckets[i].older = _newest;
+  if (_newest != NONE)
+    _buckets[_newest].newer = i;
+  else
+    _oldest = i;
+  _newest = i;
+}
+
+// Bucket of this client and route class, made the most recently used; a new one starts full
+AsyncRateLimitMiddleware::Bucket& AsyncRateLimitMiddleware::_bucket(uint32_t ip, uint16_t limit) {
+  const size_t slot = _slot(ip, limit);
+  uint16_t i = _hash[slot];
+  while (i != NONE && (_buckets[i].ip != ip || _buckets[i].limit != limit))
+    i = _buckets[i].next;
+
+  if (i != NONE) {
+    if (i != _newest) {
+      _unlink(i);
+      _linkNewest(i);
+    }
+    return _buckets[i];
+  }
+
+  if (_used < ASYNCWEBSERVER_RATE_LIMIT_CLIENTS) {
+    i = _used++;
+  } else {
+    // reuse the least recently used bucket
+    i = _oldest;
+    _unlink(i);
+    uint16_t* link = &_hash[_slot(_buckets[i].ip, _buckets[i].limit)];
+    while (*link != i)
+      link = &_buckets[*link].next;
+    *link = _buckets[i].next;
   }
 
+  Bucket& b = _buckets[i];
+  b.ip = ip;
+  b.limit = limit;
+  b.tokens = _limits[limit].maxRequests * _limits[limit].windowMillis;
+  b.updated = millis();
+  b.next = _hash[slot];
+  _hash[slot] = i;
+  _linkNewest(i);
+  return b;
+}
+
+bool AsyncRateLimitMiddleware::_allow(uint32_t ip, uint16_t limit, uint32_t& retryAfterSeconds) {
+  const size_t maxRequests = _limits[limit].maxRequests;
+  const uint32_t window = _limits[limit].windowMillis;
   retryAfterSeconds = 0;
-  return true;
+  if (!window)
+    return maxRequests > 0;
+  if (!maxRequests) {
+    retryAfterSeconds = window / 1000 + 1;
+    return false;
+  }
+
+  Bucket& b = _bucket(ip, limit);
+  const uint32_t now = millis();
+  // after a whole window the bucket is full anyway, this also bounds the product below
+  const uint32_t elapsed = std::min(now - b.updated, window);
+  b.tokens = std::min<uint32_t>(b.tokens + elapsed * maxRequests, maxRequests * window);
+  b.updated = now;
+
+  if (b.tokens >= window) {
+    b.tokens -= window;
+    return true;
+  }
+  retryAfterSeconds = (window - b.tokens + maxRequests - 1) / maxRequests / 1000 + 1;
+  return false;
+}
+
+bool AsyncRateLimitMiddleware::isRequestAllowed(uint32_t& retryAfterSeconds) {
+  return _allow(0, 0, retryAfterSeconds);
+}
+
+bool AsyncRateLimitMiddleware::isRequestAllowed(AsyncWebServerRequest* request, uint32_t& retryAfterSeconds) {
+  uint16_t limit = 0;
+  for (size_t i = 1; i < _limits.size(); i++) {
+    if (request->url().startsWith(_limits[i].prefix)) {
+      limit = i;
+      break;
+    }
+  }
+  return _allow(request->client()->remoteIP(), limit, retryAfterSeconds);
 }
 
 void AsyncRateLimitMiddleware::run(AsyncWebServerRequest* request, ArMiddlewareNext next) {
   uint32_t retryAfterSeconds;
-  if (isRequestAllowed(retryAfterSeconds)) {
+  if (isRequestAllowed(request, retryAfterSeconds)) {
     next();
   } else {
     AsyncWebServerResponse* response = request->beginResponse(429);
@@ -34,8 +34,25 @@ class AsyncStaticWebHandler : public AsyncWebHandler {
     using FS = fs::FS;
 
   private:
-    bool _getFile(AsyncWebServerRequest* request) const;
-    bool _searchFile(AsyncWebServerRequest* request, const String& path);
+    // What looking up one request path found. Later requests for it open the file once,
+    // without the exists() scans or the .gz and default file probes.
+    struct FileInfo {
+        String uri;  // request path below _uri
+        String path; // file served, as used for its content type
+        String file; // file opened, ".gz" included
+        String contentType;
+        String etag; // size and modification time, or hash of the content; computed once
+        String lastModified;
+        bool found;
+    };
+    mutable std::vector<FileInfo> _files;
+    mutable size_t _filesNext = 0;
+    mutable uint32_t _filesVersion = 0;
+    static uint32_t _fsVersion;
+
+    FileInfo* _cachedFile(const String& uri) const;
+    FileInfo* _getFile(AsyncWebServerRequest* request) const;
+    bool _searchFile(AsyncWebServerRequest* request, const String& path, FileInfo& info);
     uint8_t _countBits(const uint8_t value) const;
 
   protected:
@@ -53,6 +70,7 @@ class AsyncStaticWebHandler : public AsyncWebHandler {
     AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cache_control);
     bool canHandle(AsyncWebServerRequest* request) const override final;
     void handleRequest(AsyncWebServerRequest* request) override final;
+    WebRouteMatch routeKey(String& uri, WebRequestMethodComposite& methods) const override final;
     AsyncStaticWebHandler& setTryGzipFirst(bool value);
     AsyncStaticWebHandler& setIsDir(bool isDir);
     AsyncStaticWebHandler& setDefaultFile(const char* filename);
@@ -71,6 +89,10 @@ class AsyncStaticWebHandler : public AsyncWebHandler {
     AsyncStaticWebHandler& setLastModified();
 
     AsyncStaticWebHandler& setTemplateProcessor(AwsTemplateProcessor newCallback);
+
+    // Forget the file lookups of all static handlers: call after adding, removing or rewriting served files.
+    // Lookups, ETags and Last-Modified are cached, a file rewritten without it keeps its old validators
+    static void invalidateCache() { ++_fsVersion; }
 };
 
 class AsyncCallbackWebHandler : public AsyncWebHandler {
@@ -86,7 +108,10 @@ class AsyncCallbackWebHandler : public AsyncWebHandler {
   public:
     AsyncCallbackWebHandler() : _uri(), _method(HTTP_ANY), _onRequest(NULL), _onUpload(NULL), _onBody(NULL), _isRegex(false) {}
     void setUri(const String& uri);
-    void setMethod(WebRequestMethodComposite method) { _method = method; }
+    void setMethod(WebRequestMethodComposite method) {
+      _method = method;
+      AsyncWebRouter::invalidate();
+    }
     void onRequest(ArRequestHandlerFunction fn) { _onRequest = fn; }
     void onUpload(ArUploadHandlerFunction fn) { _onUpload = fn; }
     void onBody(ArBodyHandlerFunction fn) { _onBody = fn; }
@@ -96,6 +121,7 @@ class AsyncCallbackWebHandler : public AsyncWebHandler {
     void handleUpload(AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) override final;
     void handleBody(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) override final;
     bool isRequestHandlerTrivial() const override final { return !_onRequest; }
+    WebRouteMatch routeKey(String& uri, WebRequestMethodComposite& methods) const override final;
 };
 
 #endif /* ASYNCWEBSERVERHANDLERIMPL_H_ */
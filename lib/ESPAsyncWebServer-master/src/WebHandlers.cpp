@@ -20,6 +20,7 @@
 */
 #include "ESPAsyncWebServer.h"
 #include "WebHandlerImpl.h"
+#include "WebResponseImpl.h"
 
 using namespace asyncsrv;
 
@@ -84,7 +85,7 @@ AsyncStaticWebHandler& AsyncStaticWebHandler::setLastModified(const char* last_m
   return *this;
 }
 
-AsyncStaticWebHandler& AsyncStaticWebHandler::setLastModified(struct tm* last_modified) {
+static String __http_date(struct tm* date) {
   char result[30];
 #ifdef ESP8266
   auto formatP = PSTR("%a, %d %b %Y %H:%M:%S GMT");
@@ -94,8 +95,12 @@ AsyncStaticWebHandler& AsyncStaticWebHandler::setLastModified(struct tm* last_mo
   static constexpr const char* format = "%a, %d %b %Y %H:%M:%S GMT";
 #endif
 
-  strftime(result, sizeof(result), format, last_modified);
-  _last_modified = result;
+  strftime(result, sizeof(result), format, date);
+  return String(result);
+}
+
+AsyncStaticWebHandler& AsyncStaticWebHandler::setLastModified(struct tm* last_modified) {
+  _last_modified = __http_date(last_modified);
   return *this;
 }
 
@@ -114,38 +119,102 @@ bool AsyncStaticWebHandler::canHandle(AsyncWebServerRequest* request) const {
   return request->isHTTP() && request->method() == HTTP_GET && request->url().startsWith(_uri) && _getFile(request);
 }
 
-bool AsyncStaticWebHandler::_getFile(AsyncWebServerRequest* request) const {
+WebRouteMatch AsyncStaticWebHandler::routeKey(String& uri, WebRequestMethodComposite& methods) const {
+  uri = _uri;
+  methods = HTTP_GET;
+  return ROUTE_PREFIX;
+}
+
+#ifdef ESP32
+  #define FILE_IS_REAL(f) (f == true && !f.isDirectory())
+#else
+  #define FILE_IS_REAL(f) (f == true)
+#endif
+
+uint32_t AsyncStaticWebHandler::_fsVersion = 0;
+
+AsyncStaticWebHandler::FileInfo* AsyncStaticWebHandler::_cachedFile(const String& uri) const {
+  if (_filesVersion != _fsVersion) {
+    _files.clear();
+    _filesNext = 0;
+    _filesVersion = _fsVersion;
+  }
+  for (auto& info : _files) {
+    if (info.uri == uri)
+      return &info;
+  }
+  return nullptr;
+}
+
+// Strong entity tag from the size and the modification time. Without a modification time, from the size and an
+// FNV-1a hash of the content: reading the whole file, it is only done when the filesystem has no timestamps
+static String __file_etag(File& file, time_t lastWrite) {
+  char etag[24];
+  if (lastWrite) {
+    snprintf_P(etag, sizeof(etag), PSTR("\"%lx-%lx\""), (unsigned long)file.size(), (unsigned long)lastWrite);
+    return String(etag);
+  }
+
+  uint32_t hash = 2166136261u;
+  uint8_t buf[128];
+  size_t len;
+  while ((len = file.read(buf, sizeof(buf))) > 0) {
+    for (size_t i = 0; i < len; i++)
+      hash = (hash ^ buf[i]) * 16777619u;
+  }
+  file.seek(0);
+  snprintf_P(etag, sizeof(etag), PSTR("\"%lx-%08lx\""), (unsigned long)file.size(), (unsigned long)hash);
+  return String(etag);
+}
+
+AsyncStaticWebHandler::FileInfo* AsyncStaticWebHandler::_getFile(AsyncWebServerRequest* request) const {
   // Remove the found uri
-  String path = request->url().substring(_uri.length());
+  String uri = request->url().substring(_uri.length());
+
+  // a cached path is answered without touching the filesystem, the file is only opened to send it
+  FileInfo* cached = _cachedFile(uri);
+  if (cached)
+    return cached->found ? cached : nullptr;
+
+  FileInfo info;
+  info.uri = uri;
 
   // We can skip the file check and look for default if request is to the root of a directory or that request path ends with '/'
-  bool canSkipFileCheck = (_isDir && path.length() == 0) || (path.length() && path[path.length() - 1] == '/');
+  bool canSkipFileCheck = (_isDir && uri.length() == 0) || (uri.length() && uri[uri.length() - 1] == '/');
 
-  path = _path + path;
+  String path = _path + uri;
 
   // Do we have a file or .gz file
-  if (!canSkipFileCheck && const_cast<AsyncStaticWebHandler*>(this)->_searchFile(request, path))
-    return true;
-
-  // Can't handle if not default file
-  if (_default_file.length() == 0)
-    return false;
+  info.found = !canSkipFileCheck && const_cast<AsyncStaticWebHandler*>(this)->_searchFile(request, path, info);
 
   // Try to add default file, ensure there is a trailing '/' ot the path.
-  if (path.length() == 0 || path[path.length() - 1] != '/')
-    path += String('/');
-  path += _default_file;
+  if (!info.found && _default_file.length()) {
+    if (path.length() == 0 || path[path.length() - 1] != '/')
+      path += String('/');
+    path += _default_file;
+    info.found = const_cast<AsyncStaticWebHandler*>(this)->_searchFile(request, path, info);
+  }
 
-  return const_cast<AsyncStaticWebHandler*>(this)->_searchFile(request, path);
-}
+  if (info.found) {
+    info.contentType = AsyncFileResponse::contentTypeFromPath(info.path);
+    time_t lw = request->_tempFile.getLastWrite(); // get last file mod time (if supported by FS)
+    info.etag = __file_etag(request->_tempFile, lw);
+    if (lw)
+      info.lastModified = __http_date(gmtime(&lw));
+  }
 
-#ifdef ESP32
-  #define FILE_IS_REAL(f) (f == true && !f.isDirectory())
-#else
-  #define FILE_IS_REAL(f) (f == true)
-#endif
+  if (_files.size() < ASYNCWEBSERVER_STATIC_CACHE_SIZE) {
+    _files.push_back(info);
+    cached = &_files.back();
+  } else {
+    cached = &_files[_filesNext];
+    *cached = info;
+    _filesNext = (_filesNext + 1) % ASYNCWEBSERVER_STATIC_CACHE_SIZE;
+  }
+  return cached->found ? cached : nullptr;
+}
 
-bool AsyncStaticWebHandler::_searchFile(AsyncWebServerRequest* request, const String& path) {
+bool AsyncStaticWebHandler::_searchFile(AsyncWebServerRequest* request, const String& path, FileInfo& info) {
   bool fileFound = false;
   bool gzipFound = false;
 
@@ -178,11 +247,8 @@ bool AsyncStaticWebHandler::_searchFile(AsyncWebServerRequest* request, const St
   bool found = fileFound || gzipFound;
 
   if (found) {
-    // Extract the file name from the path and keep it in _tempObject
-    size_t pathLen = path.length();
-    char* _tempPath = (char*)malloc(pathLen + 1);
-    snprintf_P(_tempPath, pathLen + 1, PSTR("%s"), path.c_str());
-    request->_tempObject = (void*)_tempPath;
+    info.path = path;
+    info.file = gzipFound ? gzip : path;
   }
 
   return found;
@@ -197,60 +263,47 @@ uint8_t AsyncStaticWebHandler::_countBits(const uint8_t value) const {
 }
 
 void AsyncStaticWebHandler::handleRequest(AsyncWebServerRequest* request) {
-  // Get the filename from request->_tempObject and free it
-  String filename((char*)request->_tempObject);
-  free(request->_tempObject);
-  request->_tempObject = NULL;
-
-  if (request->_tempFile != true){
+  // normally cached by canHandle(), looked up again if it was dropped since
+  FileInfo* info = _getFile(request);
+  if (!info) {
     request->send(404);
     return;
   }
 
-    time_t lw = request->_tempFile.getLastWrite(); // get last file mod time (if supported by FS)
-    // set etag to lastmod timestamp if available, otherwise to size
-    String etag;
-    if (lw) {
-      setLastModified(lw);
-#if defined(TARGET_RP2040)
-      // time_t == long long int
-      constexpr size_t len = 1 + 8 * sizeof(time_t);
-      char buf[len];
-      char* ret = lltoa(lw ^ request->_tempFile.size(), buf, len, 10);
-      etag = ret ? String(ret) : String(request->_tempFile.size());
-#else
-      etag = lw ^ request->_tempFile.size();   // etag combines file size and lastmod timestamp
-#endif
-    } else {
-      etag = request->_tempFile.size();
-    }
-
-    bool not_modified = false;
+  // points into _files: taken again if the entry is looked up again below
+  const String* lastModified = info->lastModified.length() ? &info->lastModified : &_last_modified;
+  AsyncWebServerResponse* response;
 
-    // if-none-match has precedence over if-modified-since
-    if (request->hasHeader(T_INM))
-      not_modified = request->header(T_INM).equals(etag);
-    else if (_last_modified.length())
-      not_modified = request->header(T_IMS).equals(_last_modified);
-
-    AsyncWebServerResponse* response;
-
-    if (not_modified){
-      request->_tempFile.close();
-      response = new AsyncBasicResponse(304); // Not modified
-    } else {
-      response = new AsyncFileResponse(request->_tempFile, filename, emptyString, false, _callback);
+  if (request->notModified(info->etag, *lastModified)) {
+    request->_tempFile.close();
+    response = new AsyncBasicResponse(304); // Not modified
+  } else {
+    if (!request->_tempFile) {
+      request->_tempFile = _fs.open(info->file, fs::FileOpenMode::read);
+      if (!FILE_IS_REAL(request->_tempFile)) {
+        // the file went away without invalidateCache(), look it up again
+        request->_tempFile.close();
+        _files.erase(_files.begin() + (info - _files.data()));
+        _filesNext = 0;
+        info = _getFile(request);
+        if (!info) {
+          request->send(404);
+          return;
+        }
+        lastModified = info->lastModified.length() ? &info->lastModified : &_last_modified;
+      }
     }
+    response = new AsyncFileResponse(request->_tempFile, info->path, info->contentType.c_str(), false, _callback);
+  }
 
-    response->addHeader(T_ETag, etag.c_str());
+  response->addHeader(T_ETag, info->etag.c_str());
 
-    if (_last_modified.length())
-      response->addHeader(T_Last_Modified, _last_modified.c_str());
-    if (_cache_control.length())
-      response->addHeader(T_Cache_Control, _cache_control.c_str());
-  
-    request->send(response);
+  if (lastModified->length())
+    response->addHeader(T_Last_Modified, lastModified->c_str());
+  if (_cache_control.length())
+    response->addHeader(T_Cache_Control, _cache_control.c_str());
 
+  request->send(response);
 }
 
 AsyncStaticWebHandler& AsyncStaticWebHandler::setTemplateProcessor(AwsTemplateProcessor newCallback) {
@@ -261,6 +314,7 @@ AsyncStaticWebHandler& AsyncStaticWebHandler::setTemplateProcessor(AwsTemplatePr
 void AsyncCallbackWebHandler::setUri(const String& uri) {
   _uri = uri;
   _isRegex = uri.startsWith("^") && uri.endsWith("$");
+  AsyncWebRouter::invalidate();
 }
 
 bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) const {
@@ -297,6 +351,18 @@ bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest* request) const {
   return true;
 }
 
+WebRouteMatch AsyncCallbackWebHandler::routeKey(String& uri, WebRequestMethodComposite& methods) const {
+  if (_isRegex || _uri.startsWith("/*."))
+    return ROUTE_NONE;
+  methods = _method;
+  if (_uri.endsWith("*")) {
+    uri = _uri.substring(0, _uri.length() - 1);
+    return ROUTE_PREFIX;
+  }
+  uri = _uri;
+  return _uri.length() ? ROUTE_SEGMENT : ROUTE_PREFIX;
+}
+
 void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest* request) {
   if (_onRequest)
     _onRequest(request);
@@ -23,6 +23,7 @@
 #include "WebResponseImpl.h"
 #include "literals.h"
 #include <cstring>
+#include <new>
 
 #define __is_param_char(c) ((c) && ((c) != '{') && ((c) != '[') && ((c) != '&') && ((c) != '='))
 
@@ -35,7 +36,8 @@ enum { PARSE_REQ_START = 0,
        PARSE_REQ_FAIL = 4 };
 
 AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
-    : _client(c), _server(s), _handler(NULL), _response(NULL), _temp(), _parseState(PARSE_REQ_START), _version(0), _method(HTTP_ANY), _url(), _host(), _contentType(), _boundary(), _authorization(), _reqconntype(RCT_HTTP), _authMethod(AsyncAuthType::AUTH_NONE), _isMultipart(false), _isPlainPost(false), _expectingContinue(false), _contentLength(0), _parsedLength(0), _multiParseState(0), _boundaryPosition(0), _itemStartIndex(0), _itemSize(0), _itemName(), _itemFilename(), _itemType(), _itemValue(), _itemBuffer(0), _itemBufferIndex(0), _itemIsFile(false), _tempObject(NULL) {
+    : _client(c), _server(s), _handler(NULL), _response(NULL), _temp(), _parseState(PARSE_REQ_START), _partialLine(nullptr), _partialLineLength(0), _partialLineCapacity(0), _version(0), _method(HTTP_ANY), _url(), _host(), _contentType(), _boundary(), _authorization(), _reqconntype(RCT_HTTP), _authMethod(AsyncAuthType::AUTH_NONE), _isMultipart(false), _isPlainPost(false), _expectingContinue(false), _contentLength(0), _parsedLength(0), _keepAlive(false), _connectionRequests(0), _idleSince(0), _pipelined(nullptr), _pipelinedLength(0), _multiParseState(0), _boundaryPosition(0), _delimiter(nullptr), _delimiterSkip(nullptr), _delimiterLength(0), _itemStartIndex(0), _itemSize(0), _itemName(), _itemFilename(), _itemType(), _itemValue(), _itemBuffer(0), _itemBufferIndex(0), _itemIsFile(false), _tempObject(NULL) {
+  memset(_knownHeaders, 0, sizeof(_knownHeaders));
   c->onError([](void* r, AsyncClient* c, int8_t error) { (void)c; AsyncWebServerRequest *req = (AsyncWebServerRequest*)r; req->_onError(error); }, this);
   c->onAck([](void* r, AsyncClient* c, size_t len, uint32_t time) { (void)c; AsyncWebServerRequest *req = (AsyncWebServerRequest*)r; req->_onAck(len, time); }, this);
   c->onDisconnect([](void* r, AsyncClient* c) { AsyncWebServerRequest *req = (AsyncWebServerRequest*)r; req->_onDisconnect(); delete c; }, this);
@@ -45,7 +47,8 @@ AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
 }
 
 AsyncWebServerRequest::~AsyncWebServerRequest() {
-  _headers.clear();
+  removeHeaders();
+  _freeParams();
 
   _pathParams.clear();
 
@@ -64,6 +67,8 @@ AsyncWebServerRequest::~AsyncWebServerRequest() {
   if (_itemBuffer) {
     free(_itemBuffer);
   }
+
+  free(_pipelined);
 }
 
 void AsyncWebServerRequest::_onData(void* buf, size_t len) {
@@ -79,38 +84,56 @@ void AsyncWebServerRequest::_onData(void* buf, size_t len) {
   }
 #endif
 
-  size_t i = 0;
+  // Headers and params are copied in the arena: one block sized from the first segment usually holds them all
+  if (_parseState == PARSE_REQ_START) {
+    // the previous response cleared the rx timeout: a request that stalls once started must not hold the connection
+    if (_connectionRequests)
+      _client->setRxTimeout(3);
+    _arena.reserve(len + len / 4);
+  }
+
   while (true) {
 
+    if (_parseState == PARSE_REQ_END) {
+      // Pipelined request: parsed by the next request on this connection, once this one is answered
+      if (_keepAlive)
+        _pipeline(buf, len);
+      break;
+    }
+
     if (_parseState < PARSE_REQ_BODY) {
-      // Find new line in buf
-      char* str = (char*)buf;
-      for (i = 0; i < len; i++) {
-        // Check for null characters in header
-        if (!str[i]) {
+      // Find new line in buf. Lines are parsed where they are, only a line split across segments is copied
+      const char* str = (const char*)buf;
+      const char* eol = (const char*)memchr(str, '\n', len);
+      size_t lineLen = eol ? eol - str : len;
+      // Check for null characters in header
+      if (memchr(str, 0, lineLen)) {
+        _parseState = PARSE_REQ_FAIL;
+        _client->abort();
+        return;
+      }
+      if (!eol) { // No new line, keep the start of the line for the next segment
+        if (!_appendPartialLine(str, len)) {
           _parseState = PARSE_REQ_FAIL;
           _client->abort();
           return;
         }
-        if (str[i] == '\n') {
-          break;
+      } else {
+        if (_partialLineLength) {
+          if (!_appendPartialLine(str, lineLen)) {
+            _parseState = PARSE_REQ_FAIL;
+            _client->abort();
+            return;
+          }
+          _parseLine(_partialLine, _partialLineLength);
+          _partialLineLength = 0;
+        } else {
+          _parseLine(str, lineLen);
         }
-      }
-      if (i == len) { // No new line, just add the buffer in _temp
-        char ch = str[len - 1];
-        str[len - 1] = 0;
-        _temp.reserve(_temp.length() + len);
-        _temp.concat(str);
-        _temp.concat(ch);
-      } else {      // Found new line - extract it and parse
-        str[i] = 0; // Terminate the string at the end of the line.
-        _temp.concat(str);
-        _temp.trim();
-        _parseLine();
-        if (++i < len) {
+        if (++lineLen < len && _parseState < PARSE_REQ_FAIL) {
           // Still have more buffer to process
-          buf = str + i;
-          len -= i;
+          buf = (void*)(str + lineLen);
+          len -= lineLen;
           continue;
         }
       }
@@ -118,53 +141,54 @@ void AsyncWebServerRequest::_onData(void* buf, size_t len) {
       // A handler should be already attached at this point in _parseLine function.
       // If handler does nothing (_onRequest is NULL), we don't need to really parse the body.
       const bool needParse = _handler && !_handler->isRequestHandlerTrivial();
+      // Whatever follows the body belongs to the next request
+      size_t bodyLen = len;
+      if (_parsedLength < _contentLength && _contentLength - _parsedLength < len)
+        bodyLen = _contentLength - _parsedLength;
       if (_isMultipart) {
-        if (needParse) {
-          size_t i;
-          for (i = 0; i < len; i++) {
-            _parseMultipartPostByte(((uint8_t*)buf)[i], i == len - 1);
-            _parsedLength++;
-          }
-        } else
-          _parsedLength += len;
+        if (needParse)
+          _parseMultipartPost((uint8_t*)buf, bodyLen);
+        else
+          _parsedLength += bodyLen;
       } else {
         if (_parsedLength == 0) {
           if (_contentType.startsWith(T_app_xform_urlencoded)) {
             _isPlainPost = true;
           } else if (_contentType == T_text_plain && __is_param_char(((char*)buf)[0])) {
+            // __is_param_char() evaluates its argument more than once
             size_t i = 0;
-            while (i < len && __is_param_char(((char*)buf)[i++]))
-              ;
-            if (i < len && ((char*)buf)[i - 1] == '=') {
+            while (i < bodyLen && __is_param_char(((char*)buf)[i]))
+              i++;
+            if (i < bodyLen && ((char*)buf)[i] == '=') {
               _isPlainPost = true;
             }
           }
+          if (_isPlainPost && needParse && _contentLength > ASYNCWEBSERVER_MAX_FORM_SIZE) {
+            // every field ends up in the arena: don't let a client fill the heap with them
+            _parseState = PARSE_REQ_END;
+            _keepAlive = false;
+            _runRequest(413);
+            return;
+          }
         }
         if (!_isPlainPost) {
           if (_handler)
-            _handler->handleBody(this, (uint8_t*)buf, len, _parsedLength, _contentLength);
-          _parsedLength += len;
+            _handler->handleBody(this, (uint8_t*)buf, bodyLen, _parsedLength, _contentLength);
+          _parsedLength += bodyLen;
         } else if (needParse) {
-          size_t i;
-          for (i = 0; i < len; i++) {
-            _parsedLength++;
-            _parsePlainPostChar(((uint8_t*)buf)[i]);
-          }
+          _parsedLength += bodyLen;
+          _parsePlainPost((const char*)buf, bodyLen);
         } else {
-          _parsedLength += len;
+          _parsedLength += bodyLen;
         }
       }
       if (_parsedLength == _contentLength) {
         _parseState = PARSE_REQ_END;
-        _server->_runChain(this, [this]() { return _handler ? _handler->_runChain(this, [this]() { _handler->handleRequest(this); }) : send(501); });
-        if (!_sent) {
-          if (!_response)
-            send(501, T_text_plain, "Handler did not handle the request");
-          else if (!_response->_sourceValid())
-            send(500, T_text_plain, "Invalid data in handler");
-          _client->setRxTimeout(0);
-          _response->_respond(this);
-          _sent = true;
+        _runRequest();
+        if (bodyLen < len) {
+          buf = (void*)((uint8_t*)buf + bodyLen);
+          len -= bodyLen;
+          continue;
         }
       }
     }
@@ -172,17 +196,36 @@ void AsyncWebServerRequest::_onData(void* buf, size_t len) {
   }
 }
 
+// Runs the middlewares and the handler, or answers with code in place of the handler, then starts the response
+void AsyncWebServerRequest::_runRequest(int code) {
+  _server->_runChain(this, [this, code]() {
+    if (!_handler)
+      return send(code ? code : 501);
+    _handler->_runChain(this, [this, code]() { return code ? send(code) : _handler->handleRequest(this); });
+  });
+  if (!_sent) {
+    if (!_response)
+      send(501, T_text_plain, "Handler did not handle the request");
+    else if (!_response->_sourceValid())
+      send(500, T_text_plain, "Invalid data in handler");
+    _client->setRxTimeout(0);
+    _response->_respond(this);
+    _sent = true;
+  }
+}
+
 void AsyncWebServerRequest::_onPoll() {
   // os_printf("p\n");
+  if (_connectionRequests && _parseState == PARSE_REQ_START && millis() - _idleSince >= ASYNCWEBSERVER_KEEPALIVE_TIMEOUT * 1000UL) {
+    // kept alive connection with no new request
+    _client->close();
+    return;
+  }
   if (_response != NULL && _client != NULL && _client->canSend()) {
     if (!_response->_finished()) {
       _response->_ack(this, 0, 0);
     } else {
-      AsyncWebServerResponse* r = _response;
-      _response = NULL;
-      delete r;
-
-      _client->close();
+      _endResponse();
     }
   }
 }
@@ -191,17 +234,64 @@ void AsyncWebServerRequest::_onAck(size_t len, uint32_t time) {
   // os_printf("a:%u:%u\n", len, time);
   if (_response != NULL) {
     if (!_response->_finished()) {
+      // WebSocket and SSE responses delete the request in _ack(), but they never keep the connection alive
+      bool keepAlive = _response->_keepsAlive();
       _response->_ack(this, len, time);
+      if (keepAlive && _response->_finished())
+        _endResponse();
     } else if (_response->_finished()) {
-      AsyncWebServerResponse* r = _response;
-      _response = NULL;
-      delete r;
-
-      _client->close();
+      _endResponse();
     }
   }
 }
 
+// The response is sent: close the connection, or hand it over to a new request
+void AsyncWebServerRequest::_endResponse() {
+  AsyncWebServerResponse* r = _response;
+  _response = NULL;
+  bool keepAlive = _keepAlive && r->_keepsAlive() && !r->_failed();
+  delete r;
+
+  if (!keepAlive) {
+    _client->close();
+    return;
+  }
+
+  // registers itself for the events of the client
+  AsyncWebServerRequest* next = new AsyncWebServerRequest(_server, _client);
+  if (next == NULL) {
+    _client->close();
+    return;
+  }
+  next->_connectionRequests = _connectionRequests + 1;
+  next->_idleSince = millis();
+
+  uint8_t* pipelined = _pipelined;
+  size_t pipelinedLength = _pipelinedLength;
+  _pipelined = nullptr;
+  if (_onDisconnectfn) {
+    _onDisconnectfn();
+  }
+  delete this;
+
+  if (pipelined) {
+    next->_onData(pipelined, pipelinedLength);
+    free(pipelined);
+  }
+}
+
+void AsyncWebServerRequest::_pipeline(const void* data, size_t len) {
+  uint8_t* pipelined = _pipelinedLength + len <= ASYNCWEBSERVER_PIPELINE_SIZE ? (uint8_t*)realloc(_pipelined, _pipelinedLength + len) : nullptr;
+  if (!pipelined) {
+    // too far ahead of the responses: drop it, the connection is closed after this response
+    _keepAlive = false;
+    return;
+  }
+  memcpy(pipelined + _pipelinedLength, data, len);
+  _pipelined = pipelined;
+  _pipelinedLength += len;
+}
+
 void AsyncWebServerRequest::_onError(int8_t error) {
   (void)error;
 }
@@ -228,107 +318,334 @@ void AsyncWebServerRequest::_addPathParam(const char* p) {
   _pathParams.emplace_back(p);
 }
 
-void AsyncWebServerRequest::_addGetParams(const String& params) {
+// Header names with an id, indexed by WebHeaderId
+static const char* const __header_names[HDR_MAX] = {
+  nullptr,
+  T_ACCEPT,
+  T_Accept_Encoding,
+  T_AUTH,
+  T_Cache_Control,
+  T_Connection,
+  T_Content_Length,
+  T_Content_Type,
+  T_Cookie,
+  T_EXPECT,
+  T_Host,
+  T_IMS,
+  T_INM,
+  T_IF_RANGE,
+  T_Last_Event_ID,
+  T_CORS_O,
+  T_RANGE,
+  T_SEC_WS_KEY,
+  T_SEC_WS_PROTOCOL,
+  T_SEC_WS_VERSION,
+  T_Transfer_Encoding,
+  T_UPGRADE,
+};
+
+static constexpr size_t __header_strlen(const char* s) {
+  return *s ? 1 + __header_strlen(s + 1) : 0;
+}
+
+// First letter (case folded) + 5 * length is collision free over the names above: a clash would be
+// a duplicate case value in _headerId(), so adding a header that breaks it does not compile.
+static constexpr uint8_t __header_hash(const char* name, size_t len) {
+  return ((name[0] | 0x20) + len * 5) & 63;
+}
+
+static constexpr uint8_t __header_hash(const char* name) {
+  return __header_hash(name, __header_strlen(name));
+}
+
+WebHeaderId AsyncWebServerRequest::_headerId(const char* name, size_t len) {
+  if (!len)
+    return HDR_UNKNOWN;
+
+  WebHeaderId id;
+  switch (__header_hash(name, len)) {
+    // clang-format off
+    case __header_hash(T_ACCEPT):            id = HDR_ACCEPT; break;
+    case __header_hash(T_Accept_Encoding):   id = HDR_ACCEPT_ENCODING; break;
+    case __header_hash(T_AUTH):              id = HDR_AUTHORIZATION; break;
+    case __header_hash(T_Cache_Control):     id = HDR_CACHE_CONTROL; break;
+    case __header_hash(T_Connection):        id = HDR_CONNECTION; break;
+    case __header_hash(T_Content_Length):    id = HDR_CONTENT_LENGTH; break;
+    case __header_hash(T_Content_Type):      id = HDR_CONTENT_TYPE; break;
+    case __header_hash(T_Cookie):            id = HDR_COOKIE; break;
+    case __header_hash(T_EXPECT):            id = HDR_EXPECT; break;
+    case __header_hash(T_Host):              id = HDR_HOST; break;
+    case __header_hash(T_IMS):               id = HDR_IF_MODIFIED_SINCE; break;
+    case __header_hash(T_INM):               id = HDR_IF_NONE_MATCH; break;
+    case __header_hash(T_IF_RANGE):          id = HDR_IF_RANGE; break;
+    case __header_hash(T_Last_Event_ID):     id = HDR_LAST_EVENT_ID; break;
+    case __header_hash(T_CORS_O):            id = HDR_ORIGIN; break;
+    case __header_hash(T_RANGE):             id = HDR_RANGE; break;
+    case __header_hash(T_SEC_WS_KEY):        id = HDR_SEC_WS_KEY; break;
+    case __header_hash(T_SEC_WS_PROTOCOL):   id = HDR_SEC_WS_PROTOCOL; break;
+    case __header_hash(T_SEC_WS_VERSION):    id = HDR_SEC_WS_VERSION; break;
+    case __header_hash(T_Transfer_Encoding): id = HDR_TRANSFER_ENCODING; break;
+    case __header_hash(T_UPGRADE):           id = HDR_UPGRADE; break;
+    // clang-format on
+    default:
+      return HDR_UNKNOWN;
+  }
+
+  // Same slot, now check it is really that name
+  const char* known = __header_names[id];
+  return strlen(known) == len && strncasecmp(name, known, len) == 0 ? id : HDR_UNKNOWN;
+}
+
+void AsyncWebServerRequest::_addHeader(const char* name, size_t nameLen, const char* value, size_t valueLen) {
+  AsyncWebHeaderView h;
+  h.name = _arena.copy(name, nameLen);
+  h.value = _arena.copy(value, valueLen);
+  h.header = nullptr;
+  h.id = _headerId(name, nameLen);
+  if (h.name && h.value && _headers.push_back(_arena, h)) {
+    if (h.id != HDR_UNKNOWN && !_knownHeaders[h.id] && _headers.size() <= UINT16_MAX)
+      _knownHeaders[h.id] = _headers.size();
+    if (!_headerList.empty())
+      _headerList.emplace_back(h.name, h.value);
+  }
+}
+
+void AsyncWebServerRequest::_indexHeaders() {
+  memset(_knownHeaders, 0, sizeof(_knownHeaders));
+  for (size_t i = _headers.size(); i > 0; i--) {
+    WebHeaderId id = _headers[i - 1].id;
+    if (id != HDR_UNKNOWN && i <= UINT16_MAX)
+      _knownHeaders[id] = i;
+  }
+}
+
+// Index of the first header with this name, -1 if none
+int AsyncWebServerRequest::_findHeader(const char* name) const {
+  WebHeaderId id = _headerId(name, strlen(name));
+  if (id != HDR_UNKNOWN && _headers.size() <= UINT16_MAX)
+    return (int)_knownHeaders[id] - 1;
+
+  for (size_t i = 0; i < _headers.size(); i++) {
+    if (_headers[i].id == id && strcasecmp(_headers[i].name, name) == 0)
+      return i;
+  }
+  return -1;
+}
+
+void AsyncWebServerRequest::_addParam(const char* name, size_t nameLen, const char* value, size_t valueLen, bool decode, bool form, bool file, size_t size) {
+  char* n = _arena.copy(name, nameLen);
+  char* v = _arena.copy(value, valueLen);
+  if (!n || !v)
+    return;
+  if (decode) {
+    n[_urlDecodeInPlace(n, nameLen)] = 0;
+    v[_urlDecodeInPlace(v, valueLen)] = 0;
+  }
+  AsyncWebParameterView p;
+  p.name = n;
+  p.value = v;
+  p.size = size;
+  p.isForm = form;
+  p.isFile = file;
+  p.param = nullptr;
+  _params.push_back(_arena, p);
+}
+
+const AsyncWebHeader* AsyncWebServerRequest::_headerAt(size_t i) const {
+  AsyncWebHeaderView& h = _headers[i];
+  if (!h.header) {
+    void* mem = _arena.allocate(sizeof(AsyncWebHeader), alignof(AsyncWebHeader));
+    if (mem)
+      h.header = new (mem) AsyncWebHeader(h.name, h.value);
+  }
+  return h.header;
+}
+
+const AsyncWebParameter* AsyncWebServerRequest::_paramAt(size_t i) const {
+  AsyncWebParameterView& p = _params[i];
+  if (!p.param) {
+    void* mem = _arena.allocate(sizeof(AsyncWebParameter), alignof(AsyncWebParameter));
+    if (mem)
+      p.param = new (mem) AsyncWebParameter(p.name, p.value, p.isForm, p.isFile, p.size);
+  }
+  return p.param;
+}
+
+void AsyncWebServerRequest::_freeHeader(AsyncWebHeaderView& h) {
+  // the memory stays in the arena, only the Strings are freed
+  if (h.header) {
+    h.header->~AsyncWebHeader();
+    h.header = nullptr;
+  }
+}
+
+void AsyncWebServerRequest::_freeParams() {
+  for (auto& p : _params) {
+    if (p.param) {
+      p.param->~AsyncWebParameter();
+      p.param = nullptr;
+    }
+  }
+  _params.clear();
+}
+
+bool AsyncWebServerRequest::_appendPartialLine(const char* data, size_t len) {
+  if (_partialLineLength + len > _partialLineCapacity) {
+    // grow geometrically, the old copy stays in the arena
+    size_t capacity = _partialLineCapacity ? _partialLineCapacity * 2 : 64;
+    if (capacity < _partialLineLength + len)
+      capacity = _partialLineLength + len;
+    char* line = (char*)_arena.allocate(capacity, 1);
+    if (!line)
+      return false;
+    if (_partialLineLength)
+      memcpy(line, _partialLine, _partialLineLength);
+    _partialLine = line;
+    _partialLineCapacity = capacity;
+  }
+  memcpy(_partialLine + _partialLineLength, data, len);
+  _partialLineLength += len;
+  return true;
+}
+
+void AsyncWebServerRequest::_addGetParams(const char* str, size_t len) {
   size_t start = 0;
-  while (start < params.length()) {
-    int end = params.indexOf('&', start);
-    if (end < 0)
-      end = params.length();
-    int equal = params.indexOf('=', start);
-    if (equal < 0 || equal > end)
-      equal = end;
-    String name(params.substring(start, equal));
-    String value(equal + 1 < end ? params.substring(equal + 1, end) : String());
-    _params.emplace_back(urlDecode(name), urlDecode(value));
+  while (start < len) {
+    const char* amp = (const char*)memchr(str + start, '&', len - start);
+    size_t end = amp ? amp - str : len;
+    const char* eq = (const char*)memchr(str + start, '=', end - start);
+    size_t equal = eq ? eq - str : end;
+    size_t valueStart = equal + 1 < end ? equal + 1 : end;
+    _addParam(str + start, equal - start, str + valueStart, end - valueStart, true);
     start = end + 1;
   }
 }
 
-bool AsyncWebServerRequest::_parseReqHead() {
+static bool __is_token(const char* str, size_t len, const char* token) {
+  return len == strlen(token) && memcmp(str, token, len) == 0;
+}
+
+// Whether a comma separated header value like "keep-alive, Upgrade" has token, ignoring case
+static bool __has_list_token(const char* value, const char* token) {
+  size_t len = strlen(token);
+  while (*value) {
+    while (*value == ' ' || *value == '\t' || *value == ',')
+      value++;
+    const char* end = value;
+    while (*end && *end != ',')
+      end++;
+    const char* last = end;
+    while (last > value && (last[-1] == ' ' || last[-1] == '\t'))
+      last--;
+    if ((size_t)(last - value) == len && strncasecmp(value, token, len) == 0)
+      return true;
+    value = end;
+  }
+  return false;
+}
+
+bool AsyncWebServerRequest::_parseReqHead(const char* line, size_t len) {
   // Split the head into method, url and version
-  int index = _temp.indexOf(' ');
-  String m = _temp.substring(0, index);
-  index = _temp.indexOf(' ', index + 1);
-  String u = _temp.substring(m.length() + 1, index);
-  _temp = _temp.substring(index + 1);
+  const char* end = line + len;
+  const char* space = (const char*)memchr(line, ' ', len);
+  if (!space)
+    return false;
+  size_t mLen = space - line;
+  const char* u = space + 1;
+  space = (const char*)memchr(u, ' ', end - u);
+  const char* uEnd = space ? space : end;
+  const char* version = space ? space + 1 : end;
 
-  if (m == T_GET) {
+  if (__is_token(line, mLen, T_GET)) {
     _method = HTTP_GET;
-  } else if (m == T_POST) {
+  } else if (__is_token(line, mLen, T_POST)) {
     _method = HTTP_POST;
-  } else if (m == T_DELETE) {
+  } else if (__is_token(line, mLen, T_DELETE)) {
     _method = HTTP_DELETE;
-  } else if (m == T_PUT) {
+  } else if (__is_token(line, mLen, T_PUT)) {
     _method = HTTP_PUT;
-  } else if (m == T_PATCH) {
+  } else if (__is_token(line, mLen, T_PATCH)) {
     _method = HTTP_PATCH;
-  } else if (m == T_HEAD) {
+  } else if (__is_token(line, mLen, T_HEAD)) {
     _method = HTTP_HEAD;
-  } else if (m == T_OPTIONS) {
+  } else if (__is_token(line, mLen, T_OPTIONS)) {
     _method = HTTP_OPTIONS;
   } else {
     return false;
   }
 
-  String g;
-  index = u.indexOf('?');
-  if (index > 0) {
-    g = u.substring(index + 1);
-    u = u.substring(0, index);
-  }
-  _url = urlDecode(u);
-  _addGetParams(g);
+  const char* query = (const char*)memchr(u, '?', uEnd - u);
+  if (query == u)
+    query = nullptr;
+  const char* pathEnd = query ? query : uEnd;
+  char* path = _arena.copy(u, pathEnd - u);
+  if (!path)
+    return false;
+  path[_urlDecodeInPlace(path, pathEnd - u)] = 0;
+  _url = path;
+  if (query)
+    _addGetParams(query + 1, uEnd - query - 1);
 
   if (!_url.length())
     return false;
 
-  if (!_temp.startsWith(T_HTTP_1_0))
+  if ((size_t)(end - version) < strlen(T_HTTP_1_0) || memcmp(version, T_HTTP_1_0, strlen(T_HTTP_1_0)) != 0)
     _version = 1;
 
-  _temp = emptyString;
   return true;
 }
 
-bool AsyncWebServerRequest::_parseReqHeader() {
-  int index = _temp.indexOf(':');
-  if (index) {
-    String name(_temp.substring(0, index));
-    String value(_temp.substring(index + 2));
-    if (name.equalsIgnoreCase(T_Host)) {
+bool AsyncWebServerRequest::_parseReqHeader(const char* line, size_t len) {
+  const char* colon = (const char*)memchr(line, ':', len);
+  if (colon && colon != line) {
+    size_t index = colon - line;
+    size_t valueStart = index + 1;
+    while (valueStart < len && (line[valueStart] == ' ' || line[valueStart] == '\t'))
+      valueStart++;
+    size_t oldCount = _headers.size();
+    _addHeader(line, index, line + valueStart, len - valueStart);
+    if (_headers.size() == oldCount)
+      return false;
+
+    const char* value = _headers[oldCount].value;
+    WebHeaderId id = _headers[oldCount].id;
+    if (id == HDR_HOST) {
       _host = value;
-    } else if (name.equalsIgnoreCase(T_Content_Type)) {
-      _contentType = value.substring(0, value.indexOf(';'));
-      if (value.startsWith(T_MULTIPART_)) {
-        _boundary = value.substring(value.indexOf('=') + 1);
+    } else if (id == HDR_CONTENT_TYPE) {
+      const char* semicolon = strchr(value, ';');
+      _contentType = semicolon ? String(value).substring(0, semicolon - value) : String(value);
+      if (strncmp(value, T_MULTIPART_, strlen(T_MULTIPART_)) == 0) {
+        const char* equal = strchr(value, '=');
+        _boundary = equal ? equal + 1 : value;
         _boundary.replace(String('"'), String());
         _isMultipart = true;
       }
-    } else if (name.equalsIgnoreCase(T_Content_Length)) {
-      _contentLength = atoi(value.c_str());
-    } else if (name.equalsIgnoreCase(T_EXPECT) && value.equalsIgnoreCase(T_100_CONTINUE)) {
+    } else if (id == HDR_CONTENT_LENGTH) {
+      _contentLength = atoi(value);
+    } else if (id == HDR_EXPECT && strcasecmp(value, T_100_CONTINUE) == 0) {
       _expectingContinue = true;
-    } else if (name.equalsIgnoreCase(T_AUTH)) {
-      int space = value.indexOf(' ');
-      if (space == -1) {
+    } else if (id == HDR_AUTHORIZATION) {
+      const char* space = strchr(value, ' ');
+      if (space == NULL) {
         _authorization = value;
         _authMethod = AsyncAuthType::AUTH_OTHER;
       } else {
-        String method = value.substring(0, space);
-        if (method.equalsIgnoreCase(T_BASIC)) {
+        size_t methodLen = space - value;
+        if (methodLen == strlen(T_BASIC) && strncasecmp(value, T_BASIC, methodLen) == 0) {
           _authMethod = AsyncAuthType::AUTH_BASIC;
-        } else if (method.equalsIgnoreCase(T_DIGEST)) {
+        } else if (methodLen == strlen(T_DIGEST) && strncasecmp(value, T_DIGEST, methodLen) == 0) {
           _authMethod = AsyncAuthType::AUTH_DIGEST;
-        } else if (method.equalsIgnoreCase(T_BEARER)) {
+        } else if (methodLen == strlen(T_BEARER) && strncasecmp(value, T_BEARER, methodLen) == 0) {
           _authMethod = AsyncAuthType::AUTH_BEARER;
         } else {
           _authMethod = AsyncAuthType::AUTH_OTHER;
         }
-        _authorization = value.substring(space + 1);
+        _authorization = space + 1;
       }
-    } else if (name.equalsIgnoreCase(T_UPGRADE) && value.equalsIgnoreCase(T_WS)) {
+    } else if (id == HDR_UPGRADE && strcasecmp(value, T_WS) == 0) {
       // WebSocket request can be uniquely identified by header: [Upgrade: websocket]
       _reqconntype = RCT_WS;
-    } else if (name.equalsIgnoreCase(T_ACCEPT)) {
+    } else if (id == HDR_ACCEPT) {
       String lowcase(value);
       lowcase.toLowerCase();
 #ifndef ESP8266
@@ -341,38 +658,56 @@ bool AsyncWebServerRequest::_parseReqHeader() {
         _reqconntype = RCT_EVENT;
       }
     }
-    _headers.emplace_back(name, value);
   }
-#ifndef TARGET_RP2040
-  _temp.clear();
-#else
-  // Ancient PRI core does not have String::clear() method 8-()
-  _temp = emptyString;
-#endif
   return true;
 }
 
-void AsyncWebServerRequest::_parsePlainPostChar(uint8_t data) {
-  if (data && (char)data != '&')
-    _temp += (char)data;
-  if (!data || (char)data == '&' || _parsedLength == _contentLength) {
-    String name(T_BODY);
-    String value(_temp);
-    if (!(_temp.charAt(0) == '{') && !(_temp.charAt(0) == '[') && _temp.indexOf('=') > 0) {
-      name = _temp.substring(0, _temp.indexOf('='));
-      value = _temp.substring(_temp.indexOf('=') + 1);
+// Fields end at '&' or NUL and are added as params as soon as they are complete.
+// Only a field split across segments is copied before being added.
+void AsyncWebServerRequest::_parsePlainPost(const char* data, size_t len) {
+  const char* end = data + len;
+  while (data < end) {
+    const char* stop = (const char*)memchr(data, '&', end - data);
+    const char* nul = (const char*)memchr(data, 0, (stop ? stop : end) - data);
+    if (nul)
+      stop = nul;
+    if (!stop) {
+      if (!_appendPartialLine(data, end - data)) {
+        _parseState = PARSE_REQ_FAIL;
+        _client->abort();
+        return;
+      }
+      break;
+    }
+    if (_partialLineLength) {
+      if (!_appendPartialLine(data, stop - data)) {
+        _parseState = PARSE_REQ_FAIL;
+        _client->abort();
+        return;
+      }
+      _addPlainPostField(_partialLine, _partialLineLength);
+      _partialLineLength = 0;
+    } else {
+      _addPlainPostField(data, stop - data);
     }
-    _params.emplace_back(urlDecode(name), urlDecode(value), true);
+    data = stop + 1;
+  }
 
-#ifndef TARGET_RP2040
-    _temp.clear();
-#else
-    // Ancient PRI core does not have String::clear() method 8-()
-    _temp = emptyString;
-#endif
+  // last field has no terminator
+  if (_parsedLength == _contentLength && _partialLineLength) {
+    _addPlainPostField(_partialLine, _partialLineLength);
+    _partialLineLength = 0;
   }
 }
 
+void AsyncWebServerRequest::_addPlainPostField(const char* field, size_t len) {
+  const char* equal = (const char*)memchr(field, '=', len);
+  if (len && field[0] != '{' && field[0] != '[' && equal && equal != field)
+    _addParam(field, equal - field, equal + 1, len - (equal - field) - 1, true, true);
+  else
+    _addParam(T_BODY, strlen(T_BODY), field, len, true, true);
+}
+
 void AsyncWebServerRequest::_handleUploadByte(uint8_t data, bool last) {
   _itemBuffer[_itemBufferIndex++] = data;
 
@@ -384,6 +719,28 @@ void AsyncWebServerRequest::_handleUploadByte(uint8_t data, bool last) {
   }
 }
 
+void AsyncWebServerRequest::_handleUploadBytes(uint8_t* data, size_t len, bool last) {
+  if (_itemBufferIndex + len <= RESPONSE_STREAM_BUFFER_SIZE) {
+    memcpy(_itemBuffer + _itemBufferIndex, data, len);
+    _itemBufferIndex += len;
+    if (last || _itemBufferIndex == RESPONSE_STREAM_BUFFER_SIZE) {
+      if (_handler)
+        _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, false);
+      _itemBufferIndex = 0;
+    }
+    return;
+  }
+
+  // Too big for the buffer: flush it, then hand the slice over straight from the receive buffer
+  if (_itemBufferIndex) {
+    if (_handler)
+      _handler->handleUpload(this, _itemFilename, _itemSize - len - _itemBufferIndex, _itemBuffer, _itemBufferIndex, false);
+    _itemBufferIndex = 0;
+  }
+  if (_handler)
+    _handler->handleUpload(this, _itemFilename, _itemSize - len, data, len, false);
+}
+
 enum {
   EXPECT_BOUNDARY,
   PARSE_HEADERS,
@@ -398,6 +755,71 @@ enum {
   PARSE_ERROR
 };
 
+// Horspool search for the delimiter: returns how many bytes at the start of data are item content for sure,
+// that is up to the first delimiter or up to a delimiter prefix at the end of data.
+size_t AsyncWebServerRequest::_multipartContentLength(const uint8_t* data, size_t len) const {
+  const size_t m = _delimiterLength;
+  const uint8_t last = _delimiter[m - 1];
+  size_t pos = 0;
+  while (pos + m <= len) {
+    uint8_t c = data[pos + m - 1];
+    if (c == last && memcmp(data + pos, _delimiter, m - 1) == 0)
+      return pos;
+    pos += _delimiterSkip[c];
+  }
+
+  // No delimiter starts before pos, but one may start in the last m - 1 bytes and end in the next segment.
+  // The delimiter only has one '\r', at its start.
+  while (true) {
+    const uint8_t* r = (const uint8_t*)memchr(data + pos, '\r', len - pos);
+    if (!r || memcmp(r, _delimiter, len - (r - data)) == 0)
+      return r ? r - data : len;
+    pos = r - data + 1;
+  }
+}
+
+// Item content is searched for the next delimiter and written in slices,
+// only the bytes around delimiters and part headers go through _parseMultipartPostByte()
+void AsyncWebServerRequest::_parseMultipartPost(uint8_t* data, size_t len) {
+  if (!_parsedLength && _boundary.length() && _boundary.length() + 4 <= UINT8_MAX) {
+    _delimiterLength = _boundary.length() + 4;
+    uint8_t* delimiter = (uint8_t*)_arena.allocate(_delimiterLength, 1);
+    uint8_t* skip = (uint8_t*)_arena.allocate(256, 1);
+    if (delimiter && skip) {
+      memcpy(delimiter, "\r\n--", 4);
+      memcpy(delimiter + 4, _boundary.c_str(), _boundary.length());
+      memset(skip, _delimiterLength, 256);
+      for (size_t i = 0; i < _delimiterLength - 1; i++)
+        skip[delimiter[i]] = _delimiterLength - 1 - i;
+      _delimiter = delimiter;
+      _delimiterSkip = skip;
+    }
+  }
+
+  size_t i = 0;
+  while (i < len) {
+    if (_multiParseState == WAIT_FOR_RETURN1 && _delimiterSkip) {
+      size_t n = _multipartContentLength(data + i, len - i);
+      if (n) {
+        _itemSize += n;
+        if (_itemIsFile)
+          _handleUploadBytes(data + i, n, i + n == len);
+        else
+          _itemValue.concat((const char*)data + i, n);
+        i += n;
+        _parsedLength += n;
+        continue;
+      }
+    } else if (_multiParseState >= PARSING_FINISHED) {
+      _parsedLength += len - i;
+      return;
+    }
+    _parseMultipartPostByte(data[i], i == len - 1);
+    _parsedLength++;
+    i++;
+  }
+}
+
 void AsyncWebServerRequest::_parseMultipartPostByte(uint8_t data, bool last) {
 #define itemWriteByte(b)          \
   do {                            \
@@ -531,13 +953,13 @@ void AsyncWebServerRequest::_parseMultipartPostByte(uint8_t data, bool last) {
     } else if (_boundaryPosition == _boundary.length() - 1) {
       _multiParseState = DASH3_OR_RETURN2;
       if (!_itemIsFile) {
-        _params.emplace_back(_itemName, _itemValue, true);
+        _addParam(_itemName.c_str(), _itemName.length(), _itemValue.c_str(), _itemValue.length(), false, true);
       } else {
         if (_itemSize) {
           if (_handler)
             _handler->handleUpload(this, _itemFilename, _itemSize - _itemBufferIndex, _itemBuffer, _itemBufferIndex, true);
           _itemBufferIndex = 0;
-          _params.emplace_back(_itemName, _itemFilename, true, true, _itemSize);
+          _addParam(_itemName.c_str(), _itemName.length(), _itemFilename.c_str(), _itemFilename.length(), false, true, true, _itemSize);
         }
         free(_itemBuffer);
         _itemBuffer = NULL;
@@ -585,13 +1007,21 @@ void AsyncWebServerRequest::_parseMultipartPostByte(uint8_t data, bool last) {
   }
 }
 
-void AsyncWebServerRequest::_parseLine() {
+void AsyncWebServerRequest::_parseLine(const char* line, size_t len) {
+  // Trim, like String::trim()
+  while (len && isspace((unsigned char)line[len - 1]))
+    len--;
+  while (len && isspace((unsigned char)*line)) {
+    line++;
+    len--;
+  }
+
   if (_parseState == PARSE_REQ_START) {
-    if (!_temp.length()) {
+    if (!len) {
       _parseState = PARSE_REQ_FAIL;
       _client->abort();
     } else {
-      if (_parseReqHead()) {
+      if (_parseReqHead(line, len)) {
         _parseState = PARSE_REQ_HEADERS;
       } else {
         _parseState = PARSE_REQ_FAIL;
@@ -602,8 +1032,14 @@ void AsyncWebServerRequest::_parseLine() {
   }
 
   if (_parseState == PARSE_REQ_HEADERS) {
-    if (!_temp.length()) {
+    if (!len) {
       // end of headers
+      int connection = _findHeader(T_Connection);
+      const char* value = connection < 0 ? "" : _headers[connection].value;
+      _keepAlive = _reqconntype == RCT_HTTP && _connectionRequests + 1 < ASYNCWEBSERVER_KEEPALIVE_MAX_REQUESTS && (_version ? !__has_list_token(value, T_close) : __has_list_token(value, T_keep_alive));
+      // a chunked body is not decoded: its framing would be parsed as the next request
+      if (_findHeader(T_Transfer_Encoding) >= 0)
+        _keepAlive = false;
       _server->_rewriteRequest(this);
       _server->_attachHandler(this);
       if (_expectingContinue) {
@@ -614,19 +1050,10 @@ void AsyncWebServerRequest::_parseLine() {
         _parseState = PARSE_REQ_BODY;
       } else {
         _parseState = PARSE_REQ_END;
-        _server->_runChain(this, [this]() { return _handler ? _handler->_runChain(this, [this]() { _handler->handleRequest(this); }) : send(501); });
-        if (!_sent) {
-          if (!_response)
-            send(501, T_text_plain, "Handler did not handle the request");
-          else if (!_response->_sourceValid())
-            send(500, T_text_plain, "Invalid data in handler");
-          _client->setRxTimeout(0);
-          _response->_respond(this);
-          _sent = true;
-        }
+        _runRequest();
       }
     } else
-      _parseReqHeader();
+      _parseReqHeader(line, len);
   }
 }
 
@@ -635,12 +1062,7 @@ size_t AsyncWebServerRequest::headers() const {
 }
 
 bool AsyncWebServerRequest::hasHeader(const char* name) const {
-  for (const auto& h : _headers) {
-    if (h.name().equalsIgnoreCase(name)) {
-      return true;
-    }
-  }
-  return false;
+  return _findHeader(name) >= 0;
 }
 
 #ifdef ESP8266
@@ -650,8 +1072,8 @@ bool AsyncWebServerRequest::hasHeader(const __FlashStringHelper* data) const {
 #endif
 
 const AsyncWebHeader* AsyncWebServerRequest::getHeader(const char* name) const {
-  auto iter = std::find_if(std::begin(_headers), std::end(_headers), [&name](const AsyncWebHeader& header) { return header.name().equalsIgnoreCase(name); });
-  return (iter == std::end(_headers)) ? nullptr : &(*iter);
+  int i = _findHeader(name);
+  return i < 0 ? nullptr : _headerAt(i);
 }
 
 #ifdef ESP8266
@@ -673,22 +1095,52 @@ const AsyncWebHeader* AsyncWebServerRequest::getHeader(const __FlashStringHelper
 const AsyncWebHeader* AsyncWebServerRequest::getHeader(size_t num) const {
   if (num >= _headers.size())
     return nullptr;
-  return &(*std::next(_headers.cbegin(), num));
+  return _headerAt(num);
+}
+
+const std::list<AsyncWebHeader>& AsyncWebServerRequest::getHeaders() const {
+  // built on first use and then kept in step with _headers, so earlier references stay valid
+  if (_headerList.empty()) {
+    for (const auto& h : _headers) {
+      _headerList.emplace_back(h.name, h.value);
+    }
+  }
+  return _headerList;
 }
 
 size_t AsyncWebServerRequest::getHeaderNames(std::vector<const char*>& names) const {
   const size_t size = _headers.size();
   names.reserve(size);
   for (const auto& h : _headers) {
-    names.push_back(h.name().c_str());
+    names.push_back(h.name);
   }
   return size;
 }
 
 bool AsyncWebServerRequest::removeHeader(const char* name) {
   const size_t size = _headers.size();
-  _headers.remove_if([name](const AsyncWebHeader& header) { return header.name().equalsIgnoreCase(name); });
-  return size != _headers.size();
+  for (size_t i = 0; i < _headers.size();) {
+    if (strcasecmp(_headers[i].name, name) == 0) {
+      _freeHeader(_headers[i]);
+      _headers.erase(i);
+    } else {
+      i++;
+    }
+  }
+  if (size == _headers.size())
+    return false;
+  _headerList.remove_if([name](const AsyncWebHeader& h) { return strcasecmp(h.name().c_str(), name) == 0; });
+  _indexHeaders();
+  return true;
+}
+
+void AsyncWebServerRequest::removeHeaders() {
+  for (auto& h : _headers) {
+    _freeHeader(h);
+  }
+  _headers.clear();
+  _headerList.clear();
+  _indexHeaders();
 }
 
 size_t AsyncWebServerRequest::params() const {
@@ -697,7 +1149,7 @@ size_t AsyncWebServerRequest::params() const {
 
 bool AsyncWebServerRequest::hasParam(const char* name, bool post, bool file) const {
   for (const auto& p : _params) {
-    if (p.name().equals(name) && p.isPost() == post && p.isFile() == file) {
+    if (strcmp(p.name, name) == 0 && p.isForm == post && p.isFile == file) {
       return true;
     }
   }
@@ -705,9 +1157,10 @@ bool AsyncWebServerRequest::hasParam(const char* name, bool post, bool file) con
 }
 
 const AsyncWebParameter* AsyncWebServerRequest::getParam(const char* name, bool post, bool file) const {
-  for (const auto& p : _params) {
-    if (p.name() == name && p.isPost() == post && p.isFile() == file) {
-      return &p;
+  for (size_t i = 0; i < _params.size(); i++) {
+    const AsyncWebParameterView& p = _params[i];
+    if (strcmp(p.name, name) == 0 && p.isForm == post && p.isFile == file) {
+      return _paramAt(i);
     }
   }
   return nullptr;
@@ -722,7 +1175,7 @@ const AsyncWebParameter* AsyncWebServerRequest::getParam(const __FlashStringHelp
 const AsyncWebParameter* AsyncWebServerRequest::getParam(size_t num) const {
   if (num >= _params.size())
     return nullptr;
-  return &(*std::next(_params.cbegin(), num));
+  return _paramAt(num);
 }
 
 const String& AsyncWebServerRequest::getAttribute(const char* name, const String& defaultValue) const {
@@ -752,6 +1205,18 @@ AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const cha
   return new AsyncBasicResponse(code, contentType, content);
 }
 
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const AsyncWebResponseHead& head, const char* content) {
+  return new AsyncBasicResponse(head, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(const AsyncWebResponseHead& head, const String& content) {
+  return new AsyncBasicResponse(head, content);
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer) {
+  return new AsyncTemplateResponse(code, contentType, tpl, renderer, _version);
+}
+
 AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const char* contentType, const uint8_t* content, size_t len, AwsTemplateProcessor callback) {
   return new AsyncProgmemResponse(code, contentType, content, len, callback);
 }
@@ -804,6 +1269,49 @@ void AsyncWebServerRequest::redirect(const char* url, int code) {
   send(response);
 }
 
+// If-None-Match is "*" or a list of entity tags, weak ones (W/) compare by their opaque tag
+static bool __etag_matches(const String& list, const String& etag) {
+  const char* p = list.c_str();
+  while (*p) {
+    while (*p == ' ' || *p == '\t' || *p == ',')
+      p++;
+    if (*p == '*')
+      return true;
+    if (p[0] == 'W' && p[1] == '/')
+      p += 2;
+    const char* end = strchr(p, ',');
+    size_t len = end ? end - p : strlen(p);
+    while (len && (p[len - 1] == ' ' || p[len - 1] == '\t'))
+      len--;
+    if (len && len == etag.length() && memcmp(p, etag.c_str(), len) == 0)
+      return true;
+    p += len;
+    while (*p && *p != ',')
+      p++;
+  }
+  return false;
+}
+
+bool AsyncWebServerRequest::notModified(const String& etag, const String& lastModified) const {
+  // if-none-match has precedence over if-modified-since
+  const AsyncWebHeader* inm = getHeader(T_INM);
+  if (inm)
+    return etag.length() && __etag_matches(inm->value(), etag);
+  if (!lastModified.length())
+    return false;
+  const AsyncWebHeader* ims = getHeader(T_IMS);
+  return ims && ims->value().equals(lastModified);
+}
+
+bool AsyncWebServerRequest::sendNotModified(const String& etag) {
+  if (!notModified(etag))
+    return false;
+  AsyncWebServerResponse* response = beginResponse(304);
+  response->addHeader(T_ETag, etag.c_str());
+  send(response);
+  return true;
+}
+
 bool AsyncWebServerRequest::authenticate(const char* username, const char* password, const char* realm, bool passwordIsHash) const {
   if (_authorization.length()) {
     if (_authMethod == AsyncAuthType::AUTH_DIGEST)
@@ -879,7 +1387,7 @@ void AsyncWebServerRequest::requestAuthentication(AsyncAuthType method, const ch
 
 bool AsyncWebServerRequest::hasArg(const char* name) const {
   for (const auto& arg : _params) {
-    if (arg.name() == name) {
+    if (strcmp(arg.name, name) == 0) {
       return true;
     }
   }
@@ -893,9 +1401,10 @@ bool AsyncWebServerRequest::hasArg(const __FlashStringHelper* data) const {
 #endif
 
 const String& AsyncWebServerRequest::arg(const char* name) const {
-  for (const auto& arg : _params) {
-    if (arg.name() == name) {
-      return arg.value();
+  for (size_t i = 0; i < _params.size(); i++) {
+    if (strcmp(_params[i].name, name) == 0) {
+      const AsyncWebParameter* p = _paramAt(i);
+      return p ? p->value() : emptyString;
     }
   }
   return emptyString;
@@ -908,11 +1417,13 @@ const String& AsyncWebServerRequest::arg(const __FlashStringHelper* data) const
 #endif
 
 const String& AsyncWebServerRequest::arg(size_t i) const {
-  return getParam(i)->value();
+  const AsyncWebParameter* p = getParam(i);
+  return p ? p->value() : emptyString;
 }
 
 const String& AsyncWebServerRequest::argName(size_t i) const {
-  return getParam(i)->name();
+  const AsyncWebParameter* p = getParam(i);
+  return p ? p->name() : emptyString;
 }
 
 const String& AsyncWebServerRequest::pathArg(size_t i) const {
@@ -963,6 +1474,26 @@ String AsyncWebServerRequest::urlDecode(const String& text) const {
   return decoded;
 }
 
+// Same decoding as urlDecode(), but in place: returns the decoded length, which is never longer
+size_t AsyncWebServerRequest::_urlDecodeInPlace(char* text, size_t len) {
+  char temp[] = "0x00";
+  size_t i = 0;
+  size_t out = 0;
+  while (i < len) {
+    char encodedChar = text[i++];
+    if ((encodedChar == '%') && (i + 1 < len)) {
+      temp[2] = text[i++];
+      temp[3] = text[i++];
+      text[out++] = strtol(temp, NULL, 16);
+    } else if (encodedChar == '+') {
+      text[out++] = ' ';
+    } else {
+      text[out++] = encodedChar;
+    }
+  }
+  return out;
+}
+
 const char* AsyncWebServerRequest::methodToString() const {
   if (_method == HTTP_ANY)
     return T_ANY;
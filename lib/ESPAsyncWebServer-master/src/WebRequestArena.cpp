@@ -0,0 +1,69 @@
+/*
+  Asynchronous WebServer library for Espressif MCUs
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+  This file is part of the esp8266 core for Arduino environment.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "ESPAsyncWebServer.h"
+
+void AsyncWebRequestArena::reserve(size_t size) {
+  if (!_blocks && size > _firstBlockSize)
+    _firstBlockSize = size;
+}
+
+void* AsyncWebRequestArena::allocate(size_t size, size_t align) {
+  if (_blocks) {
+    uintptr_t base = (uintptr_t)(_blocks + 1);
+    uintptr_t p = (base + _blocks->used + align - 1) & ~(uintptr_t)(align - 1);
+    if (p + size <= base + _blocks->size) {
+      _blocks->used = p + size - base;
+      return (void*)p;
+    }
+  }
+
+  // New block: the first one is sized from the first receive buffer, then each block doubles
+  size_t blockSize = _blocks ? _blocks->size * 2 : _firstBlockSize;
+  if (blockSize < size + align)
+    blockSize = size + align;
+  Block* block = (Block*)malloc(sizeof(Block) + blockSize);
+  if (!block)
+    return nullptr;
+  block->next = _blocks;
+  block->size = blockSize;
+  block->used = 0;
+  _blocks = block;
+  _blockCount++;
+  return allocate(size, align);
+}
+
+char* AsyncWebRequestArena::copy(const char* data, size_t len) {
+  char* str = (char*)allocate(len + 1, 1);
+  if (str) {
+    memcpy(str, data, len);
+    str[len] = 0;
+  }
+  return str;
+}
+
+void AsyncWebRequestArena::release() {
+  while (_blocks) {
+    Block* next = _blocks->next;
+    free(_blocks);
+    _blocks = next;
+  }
+  _blockCount = 0;
+}
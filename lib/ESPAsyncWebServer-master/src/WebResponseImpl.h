@@ -40,11 +40,22 @@ class AsyncBasicResponse : public AsyncWebServerResponse {
   public:
     explicit AsyncBasicResponse(int code, const char* contentType = asyncsrv::empty, const char* content = asyncsrv::empty);
     AsyncBasicResponse(int code, const String& contentType, const String& content = emptyString) : AsyncBasicResponse(code, contentType.c_str(), content.c_str()) {}
+    AsyncBasicResponse(const AsyncWebResponseHead& head, const char* content);
+    AsyncBasicResponse(const AsyncWebResponseHead& head, const String& content);
     void _respond(AsyncWebServerRequest* request) override final;
     size_t _ack(AsyncWebServerRequest* request, size_t len, uint32_t time) override final;
     bool _sourceValid() const override final { return true; }
 };
 
+// Send buffers shared by all streamed responses. A buffer is only held while one _ack() fills it
+// and hands it to the client, so a few of them serve every connection. When all are taken
+// (responses sent from more than one task) a temporary buffer is allocated instead.
+class AsyncWebSendBuffers {
+  public:
+    static uint8_t* acquire();
+    static void release(uint8_t* buf);
+};
+
 class AsyncAbstractResponse : public AsyncWebServerResponse {
   private:
     // amount of responce data in-flight, i.e. sent, but not acked yet
@@ -52,6 +63,8 @@ class AsyncAbstractResponse : public AsyncWebServerResponse {
     // in-flight queue credits
     size_t _in_flight_credit{2};
     String _head;
+    // bytes of _head already written when it did not fit the socket buffer at once
+    size_t _headWritten{0};
     // Data is inserted into cache at begin().
     // This is inefficient with vector, but if we use some other container,
     // we won't be able to access it as contiguous array of bytes when reading from it,
@@ -59,6 +72,8 @@ class AsyncAbstractResponse : public AsyncWebServerResponse {
     std::vector<uint8_t> _cache;
     size_t _readDataFromCacheOrContent(uint8_t* data, const size_t len);
     size_t _fillBufferAndProcessTemplates(uint8_t* buf, size_t maxLen);
+    // Range / If-Range: turns a 200 into 206 Partial Content (or 416) for one range of the content
+    void _assembleRange(AsyncWebServerRequest* request);
 
   protected:
     AwsTemplateProcessor _callback;
@@ -70,6 +85,10 @@ class AsyncAbstractResponse : public AsyncWebServerResponse {
     size_t _ack(AsyncWebServerRequest* request, size_t len, uint32_t time) override final;
     virtual bool _sourceValid() const { return false; }
     virtual size_t _fillBuffer(uint8_t* buf __attribute__((unused)), size_t maxLen __attribute__((unused))) { return 0; }
+    // content that can start at any offset can answer Range requests
+    virtual bool _seekable() const { return false; }
+    // move to `offset` of the content, only called before the first _fillBuffer()
+    virtual bool _seek(size_t offset __attribute__((unused))) { return false; }
 };
 
 #ifndef TEMPLATE_PLACEHOLDER
@@ -84,9 +103,11 @@ class AsyncFileResponse : public AsyncAbstractResponse {
   private:
     File _content;
     String _path;
-    void _setContentTypeFromPath(const String& path);
+    void _setContentTypeFromPath(const String& path) { _contentType = contentTypeFromPath(path); }
 
   public:
+    // Content type for the extension of `path`
+    static String contentTypeFromPath(const String& path);
     AsyncFileResponse(FS& fs, const String& path, const char* contentType = asyncsrv::empty, bool download = false, AwsTemplateProcessor callback = nullptr);
     AsyncFileResponse(FS& fs, const String& path, const String& contentType, bool download = false, AwsTemplateProcessor callback = nullptr) : AsyncFileResponse(fs, path, contentType.c_str(), download, callback) {}
     AsyncFileResponse(File content, const String& path, const char* contentType = asyncsrv::empty, bool download = false, AwsTemplateProcessor callback = nullptr);
@@ -94,6 +115,8 @@ class AsyncFileResponse : public AsyncAbstractResponse {
     ~AsyncFileResponse() { _content.close(); }
     bool _sourceValid() const override final { return !!(_content); }
     size_t _fillBuffer(uint8_t* buf, size_t maxLen) override final;
+    bool _seekable() const override final { return true; }
+    bool _seek(size_t offset) override final { return _content.seek(offset); }
 };
 
 class AsyncStreamResponse : public AsyncAbstractResponse {
@@ -117,6 +140,12 @@ class AsyncCallbackResponse : public AsyncAbstractResponse {
     AsyncCallbackResponse(const String& contentType, size_t len, AwsResponseFiller callback, AwsTemplateProcessor templateCallback = nullptr) : AsyncCallbackResponse(contentType.c_str(), len, callback, templateCallback) {}
     bool _sourceValid() const override final { return !!(_content); }
     size_t _fillBuffer(uint8_t* buf, size_t maxLen) override final;
+    // the callback is asked for data from `index` on
+    bool _seekable() const override final { return true; }
+    bool _seek(size_t offset) override final {
+      _filledLength = offset;
+      return true;
+    }
 };
 
 class AsyncChunkedResponse : public AsyncAbstractResponse {
@@ -141,6 +170,47 @@ class AsyncProgmemResponse : public AsyncAbstractResponse {
     AsyncProgmemResponse(int code, const String& contentType, const uint8_t* content, size_t len, AwsTemplateProcessor callback = nullptr) : AsyncProgmemResponse(code, contentType.c_str(), content, len, callback) {}
     bool _sourceValid() const override final { return true; }
     size_t _fillBuffer(uint8_t* buf, size_t maxLen) override final;
+    bool _seekable() const override final { return true; }
+    bool _seek(size_t offset) override final {
+      _content += offset;
+      return true;
+    }
+};
+
+// Output of an AwsTemplateRenderer: writes the value straight into the response buffer.
+// A value that does not fit is rendered again on the next fill, skipping what was already sent.
+class AsyncTemplateWriter : public Print {
+  private:
+    uint8_t* _buf;
+    size_t _space;
+    size_t _skip;
+    size_t _length;
+    size_t _position;
+
+  public:
+    AsyncTemplateWriter(uint8_t* buf, size_t space, size_t skip) : _buf(buf), _space(space), _skip(skip), _length(0), _position(0) {}
+    size_t write(const uint8_t* data, size_t len) override;
+    size_t write(uint8_t data) override { return write(&data, 1); }
+    using Print::write;
+    // bytes written into the buffer
+    size_t length() const { return _length; }
+    // the value did not fit
+    bool full() const { return _position > _skip + _length; }
+};
+
+class AsyncTemplateResponse : public AsyncAbstractResponse {
+  private:
+    const AsyncWebTemplate& _template;
+    AwsTemplateRenderer _renderer;
+    size_t _segment;
+    // bytes of the current segment already sent
+    size_t _offset;
+
+  public:
+    // not chunked: the body ends when the connection closes, for HTTP/1.0 clients
+    AsyncTemplateResponse(int code, const char* contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer = nullptr, bool chunked = true);
+    bool _sourceValid() const override final { return true; }
+    size_t _fillBuffer(uint8_t* buf, size_t maxLen) override final;
 };
 
 class AsyncResponseStream : public AsyncAbstractResponse, public Print {
@@ -20,6 +20,9 @@
 */
 #include "ESPAsyncWebServer.h"
 #include "WebResponseImpl.h"
+#ifdef ESP32
+  #include <mutex>
+#endif
 
 using namespace asyncsrv;
 
@@ -127,28 +130,54 @@ const char* AsyncWebServerResponse::responseCodeToString(int code) {
 }
 
 AsyncWebServerResponse::AsyncWebServerResponse()
-    : _code(0), _contentType(), _contentLength(0), _sendContentLength(true), _chunked(false), _headLength(0), _sentLength(0), _ackedLength(0), _writtenLength(0), _state(RESPONSE_SETUP) {
+    : _code(0), _contentType(), _contentLength(0), _sendContentLength(true), _chunked(false), _headLength(0), _sentLength(0), _ackedLength(0), _writtenLength(0), _state(RESPONSE_SETUP), _keepAlive(false), _frozenHead(nullptr) {
   for (const auto& header : DefaultHeaders::Instance()) {
     _headers.emplace_back(header);
   }
 }
 
 void AsyncWebServerResponse::setCode(int code) {
-  if (_state == RESPONSE_SETUP)
+  if (_state == RESPONSE_SETUP) {
+    _thawHead();
     _code = code;
+  }
 }
 
 void AsyncWebServerResponse::setContentLength(size_t len) {
-  if (_state == RESPONSE_SETUP && addHeader(T_Content_Length, len, true))
+  if (_state != RESPONSE_SETUP)
+    return;
+  _thawHead();
+  if (addHeader(T_Content_Length, len, true))
     _contentLength = len;
 }
 
 void AsyncWebServerResponse::setContentType(const char* type) {
-  if (_state == RESPONSE_SETUP && addHeader(T_Content_Type, type, true))
+  if (_state != RESPONSE_SETUP)
+    return;
+  _thawHead();
+  if (addHeader(T_Content_Type, type, true))
     _contentType = type;
 }
 
+void AsyncWebServerResponse::_thawHead() {
+  if (!_frozenHead)
+    return;
+  // default and head headers first, then the ones added to this response
+  std::list<AsyncWebHeader> added;
+  added.swap(_headers);
+  for (const auto& header : DefaultHeaders::Instance())
+    _headers.emplace_back(header);
+  for (const auto& header : _frozenHead->_headers)
+    _headers.emplace_back(header);
+  _headers.splice(_headers.end(), added);
+  if (!_contentType.length())
+    _contentType = _frozenHead->_contentType;
+  _frozenHead = nullptr;
+}
+
 bool AsyncWebServerResponse::removeHeader(const char* name) {
+  // it may be one of the head's
+  _thawHead();
   for (auto i = _headers.begin(); i != _headers.end(); ++i) {
     if (i->name().equalsIgnoreCase(name)) {
       _headers.erase(i);
@@ -183,6 +212,46 @@ bool AsyncWebServerResponse::addHeader(const char* name, const char* value, bool
 }
 
 void AsyncWebServerResponse::_assembleHead(String& buffer, uint8_t version) {
+  if (_frozenHead) {
+    // only the version, the length and the connection change: headers added to this response go at the end.
+    // The head is copied in one reserved block, the body is appended to it before the single write
+    const String& head = _frozenHead->head();
+    size_t len = head.length() + 64;
+    for (const auto& header : _headers)
+      len += header.name().length() + header.value().length() + 4;
+    buffer.reserve(len);
+    buffer.concat(head.c_str(), 7); // "HTTP/1."
+    buffer.concat(version);
+    buffer.concat(head.c_str() + 8, head.length() - 8);
+    if (_chunked && version) {
+      buffer.concat(T_Transfer_Encoding);
+      buffer.concat(": ");
+      buffer.concat(T_chunked);
+      buffer.concat(T_rn);
+    }
+    if (_sendContentLength) {
+      buffer.concat(T_Content_Length);
+      buffer.concat(": ");
+      buffer.concat(_contentLength);
+      buffer.concat(T_rn);
+    }
+    if (!getHeader(T_Connection)) {
+      buffer.concat(T_Connection);
+      buffer.concat(": ");
+      buffer.concat(_keepAlive ? T_keep_alive : T_close);
+      buffer.concat(T_rn);
+    }
+    for (const auto& header : _headers) {
+      buffer.concat(header.name());
+      buffer.concat(": ");
+      buffer.concat(header.value());
+      buffer.concat(T_rn);
+    }
+    buffer.concat(T_rn);
+    _headLength = buffer.length();
+    return;
+  }
+
   if (version) {
     addHeader(T_Accept_Ranges, T_none, false);
     if (_chunked)
@@ -233,6 +302,17 @@ void AsyncWebServerResponse::_assembleHead(String& buffer, uint8_t version) {
   _headLength = buffer.length();
 }
 
+void AsyncWebServerResponse::_assembleConnection(AsyncWebServerRequest* request) {
+  // the end of the response must be known without closing the connection
+  _keepAlive = request->_keepAlive && (_sendContentLength || (_chunked && request->version()));
+  if (!_frozenHead) // otherwise added by _assembleHead(), unless the handler set one
+    addHeader(T_Connection, _keepAlive ? T_keep_alive : T_close, false);
+  // a Connection header set by the handler wins
+  const AsyncWebHeader* h = getHeader(T_Connection);
+  if (h && !h->value().equalsIgnoreCase(T_keep_alive))
+    _keepAlive = false;
+}
+
 bool AsyncWebServerResponse::_started() const { return _state > RESPONSE_SETUP; }
 bool AsyncWebServerResponse::_finished() const { return _state > RESPONSE_WAIT_ACK; }
 bool AsyncWebServerResponse::_failed() const { return _state == RESPONSE_FAILED; }
@@ -248,6 +328,112 @@ size_t AsyncWebServerResponse::_ack(AsyncWebServerRequest* request, size_t len,
   return 0;
 }
 
+String AsyncWebServerResponse::versionETag(uint32_t version) {
+  char etag[12];
+  snprintf_P(etag, sizeof(etag), PSTR("\"%08lx\""), (unsigned long)version);
+  return String(etag);
+}
+
+/*
+ * Response Head
+ * */
+
+AsyncWebResponseHead::AsyncWebResponseHead(int code, const char* contentType) : _code(code), _contentType(contentType) {}
+
+AsyncWebResponseHead& AsyncWebResponseHead::addHeader(const char* name, const char* value) {
+  _headers.emplace_back(name, value);
+  _head = emptyString;
+  return *this;
+}
+
+const String& AsyncWebResponseHead::head() const {
+  if (_head.length())
+    return _head;
+
+  const char* reason = AsyncWebServerResponse::responseCodeToString(_code);
+  size_t len = 50 + strlen(reason) + _contentType.length();
+  for (const auto& header : DefaultHeaders::Instance())
+    len += header.name().length() + header.value().length() + 4;
+  for (const auto& header : _headers)
+    len += header.name().length() + header.value().length() + 4;
+  _head.reserve(len);
+
+  _head.concat("HTTP/1.1 ");
+  _head.concat(_code);
+  _head.concat(' ');
+  _head.concat(reason);
+  _head.concat(T_rn);
+  for (const auto& header : DefaultHeaders::Instance())
+    _head.concat(header.toString());
+  for (const auto& header : _headers)
+    _head.concat(header.toString());
+  _head.concat(T_Accept_Ranges);
+  _head.concat(": ");
+  _head.concat(T_none);
+  _head.concat(T_rn);
+  if (_contentType.length()) {
+    _head.concat(T_Content_Type);
+    _head.concat(": ");
+    _head.concat(_contentType);
+    _head.concat(T_rn);
+  }
+  return _head;
+}
+
+/*
+ * Template
+ * */
+
+AsyncWebTemplate::AsyncWebTemplate(const char* text, size_t len) {
+  const char* end = text + len;
+  const char* start = text;
+  const char* p = text;
+  while ((p = (const char*)memchr(p, TEMPLATE_PLACEHOLDER, end - p))) {
+    const char* close = p + 1;
+    while (close < end && close - p <= TEMPLATE_PARAM_NAME_LENGTH && (isalnum((unsigned char)*close) || *close == '_'))
+      close++;
+    if (close == end || *close != TEMPLATE_PLACEHOLDER || close - p > TEMPLATE_PARAM_NAME_LENGTH + 1) {
+      // a lone '%', as in "width: 100%"
+      p++;
+      continue;
+    }
+    if (close == p + 1) {
+      // "%%", keep one of them
+      _addText(start, p + 1 - start);
+    } else {
+      _addText(start, p - start);
+      _segments.push_back({nullptr, 0, _addName(p + 1, close - p - 1)});
+    }
+    start = p = close + 1;
+  }
+  _addText(start, end - start);
+  _segments.shrink_to_fit();
+}
+
+void AsyncWebTemplate::_addText(const char* data, size_t len) {
+  if (len)
+    _segments.push_back({data, len, -1});
+}
+
+int AsyncWebTemplate::_addName(const char* name, size_t len) {
+  for (size_t i = 0; i < _names.size(); i++) {
+    if (_names[i].length() == len && memcmp(_names[i].c_str(), name, len) == 0)
+      return i;
+  }
+  String n;
+  n.concat(name, len);
+  _names.push_back(n);
+  return _names.size() - 1;
+}
+
+int AsyncWebTemplate::id(const char* name) const {
+  for (size_t i = 0; i < _names.size(); i++) {
+    if (_names[i] == name)
+      return i;
+  }
+  return -1;
+}
+
 /*
  * String/Code Response
  * */
@@ -260,11 +446,22 @@ AsyncBasicResponse::AsyncBasicResponse(int code, const char* contentType, const
     if (!_contentType.length())
       _contentType = T_text_plain;
   }
-  addHeader(T_Connection, T_close, false);
+}
+
+AsyncBasicResponse::AsyncBasicResponse(const AsyncWebResponseHead& head, const char* content) : AsyncBasicResponse(head, String(content)) {}
+
+AsyncBasicResponse::AsyncBasicResponse(const AsyncWebResponseHead& head, const String& content) {
+  _code = head.code();
+  _frozenHead = &head;
+  _content = content;
+  _contentLength = _content.length();
+  // default headers are part of the head
+  _headers.clear();
 }
 
 void AsyncBasicResponse::_respond(AsyncWebServerRequest* request) {
   _state = RESPONSE_HEADERS;
+  _assembleConnection(request);
   String out;
   _assembleHead(out, request->version());
   size_t outLen = out.length();
@@ -325,6 +522,51 @@ size_t AsyncBasicResponse::_ack(AsyncWebServerRequest* request, size_t len, uint
   return 0;
 }
 
+/*
+ * Send Buffers
+ * */
+
+#ifdef ESP32
+static std::mutex __send_buffers_lock;
+#endif
+static uint8_t* __send_buffers[ASYNCWEBSERVER_SEND_BUFFERS];
+static bool __send_buffers_used[ASYNCWEBSERVER_SEND_BUFFERS];
+
+uint8_t* AsyncWebSendBuffers::acquire() {
+  {
+#ifdef ESP32
+    std::lock_guard<std::mutex> lock(__send_buffers_lock);
+#endif
+    for (size_t i = 0; i < ASYNCWEBSERVER_SEND_BUFFERS; i++) {
+      if (__send_buffers_used[i])
+        continue;
+      // allocated on first use, then kept for the lifetime of the server
+      if (!__send_buffers[i])
+        __send_buffers[i] = (uint8_t*)malloc(ASYNCWEBSERVER_SEND_BUFFER_SIZE);
+      if (!__send_buffers[i])
+        break;
+      __send_buffers_used[i] = true;
+      return __send_buffers[i];
+    }
+  }
+  return (uint8_t*)malloc(ASYNCWEBSERVER_SEND_BUFFER_SIZE);
+}
+
+void AsyncWebSendBuffers::release(uint8_t* buf) {
+  {
+#ifdef ESP32
+    std::lock_guard<std::mutex> lock(__send_buffers_lock);
+#endif
+    for (size_t i = 0; i < ASYNCWEBSERVER_SEND_BUFFERS; i++) {
+      if (__send_buffers[i] == buf) {
+        __send_buffers_used[i] = false;
+        return;
+      }
+    }
+  }
+  free(buf);
+}
+
 /*
  * Abstract Response
  * */
@@ -338,8 +580,88 @@ AsyncAbstractResponse::AsyncAbstractResponse(AwsTemplateProcessor callback) : _c
   }
 }
 
+// Single "bytes=first-last", "bytes=first-" or "bytes=-suffix" range of `length` bytes.
+// Returns 1 for a satisfiable range, -1 for an unsatisfiable one, 0 when the header is ignored (malformed or several ranges)
+static int __parse_range(const char* spec, size_t length, size_t& first, size_t& last) {
+  size_t unitLen = strlen(T_bytes);
+  if (strncasecmp(spec, T_bytes, unitLen) != 0 || spec[unitLen] != '=' || strchr(spec, ','))
+    return 0;
+  const char* p = spec + unitLen + 1;
+  while (*p == ' ')
+    p++;
+  char* end;
+  if (*p == '-') {
+    if (!isdigit((unsigned char)p[1]))
+      return 0;
+    unsigned long suffix = strtoul(p + 1, &end, 10);
+    if (*end && *end != ' ')
+      return 0;
+    if (!suffix)
+      return -1;
+    first = suffix < length ? length - suffix : 0;
+    last = length - 1;
+    return 1;
+  }
+  if (!isdigit((unsigned char)*p))
+    return 0;
+  first = strtoul(p, &end, 10);
+  if (*end != '-')
+    return 0;
+  p = end + 1;
+  last = length - 1;
+  if (isdigit((unsigned char)*p)) {
+    unsigned long to = strtoul(p, &end, 10);
+    if (to < first)
+      return 0;
+    if (to < last)
+      last = to;
+    p = end;
+  }
+  if (*p && *p != ' ')
+    return 0;
+  return first < length ? 1 : -1;
+}
+
+void AsyncAbstractResponse::_assembleRange(AsyncWebServerRequest* request) {
+  // only the whole, unprocessed content of a 200 has byte offsets a client can resume from
+  if (_code != 200 || !_sendContentLength || _chunked || _callback || !_seekable())
+    return;
+  addHeader(T_Accept_Ranges, T_bytes);
+
+  const AsyncWebHeader* range = request->getHeader(T_RANGE);
+  if (!range || request->method() != HTTP_GET)
+    return;
+  // If-Range: the range only applies to the representation the client already has part of
+  const AsyncWebHeader* ifRange = request->getHeader(T_IF_RANGE);
+  if (ifRange) {
+    const String& validator = ifRange->value();
+    const AsyncWebHeader* current = getHeader(validator.startsWith("\"") ? T_ETag : T_Last_Modified);
+    if (!current || current->value() != validator)
+      return;
+  }
+
+  size_t first, last;
+  int satisfiable = __parse_range(range->value().c_str(), _contentLength, first, last);
+  if (!satisfiable)
+    return;
+  char contentRange[48];
+  if (satisfiable < 0) {
+    snprintf_P(contentRange, sizeof(contentRange), PSTR("bytes */%u"), (unsigned)_contentLength);
+    _code = 416;
+    _contentLength = 0;
+  } else {
+    if (!_seek(first))
+      return;
+    snprintf_P(contentRange, sizeof(contentRange), PSTR("bytes %u-%u/%u"), (unsigned)first, (unsigned)last, (unsigned)_contentLength);
+    _code = 206;
+    _contentLength = last - first + 1;
+  }
+  addHeader(T_Content_Range, contentRange);
+}
+
 void AsyncAbstractResponse::_respond(AsyncWebServerRequest* request) {
-  addHeader(T_Connection, T_close, false);
+  _assembleRange(request);
+  _assembleConnection(request);
   _assembleHead(_head, request->version());
   _state = RESPONSE_HEADERS;
   _ack(request, 0, 0);
@@ -369,18 +691,18 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest* request, size_t len, u
   // get the size of available sock space
   size_t space = request->client()->space();
 
-  size_t headLen = _head.length();
+  size_t headLen = _head.length() - _headWritten;
   if (_state == RESPONSE_HEADERS) {
     if (space >= headLen) {
       _state = RESPONSE_CONTENT;
       space -= headLen;
     } else {
-      String out = _head.substring(0, space);
-      _head = _head.substring(space);
-      _writtenLength += request->client()->write(out.c_str(), out.length());
-      _in_flight += out.length();
+      size_t written = request->client()->write(_head.c_str() + _headWritten, space);
+      _headWritten += written;
+      _writtenLength += written;
+      _in_flight += written;
       --_in_flight_credit; // take a credit
-      return out.length();
+      return written;
     }
   }
 
@@ -409,64 +731,65 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest* request, size_t len, u
     } else {
       outLen = ((_contentLength - _sentLength) > space) ? space : (_contentLength - _sentLength);
     }
+    if (outLen > ASYNCWEBSERVER_SEND_BUFFER_SIZE)
+      outLen = ASYNCWEBSERVER_SEND_BUFFER_SIZE;
 
-    uint8_t* buf = (uint8_t*)malloc(outLen + headLen);
+    // the head is queued straight from _head, the buffer only holds content
+    uint8_t* buf = AsyncWebSendBuffers::acquire();
     if (!buf) {
-      // os_printf("_ack malloc %d failed\n", outLen+headLen);
       return 0;
     }
 
-    if (headLen) {
-      memcpy(buf, _head.c_str(), _head.length());
-    }
-
     size_t readLen = 0;
 
     if (_chunked) {
       // HTTP 1.1 allows leading zeros in chunk length. Or spaces may be added.
       // See RFC2616 sections 2, 3.6.1.
-      readLen = _fillBufferAndProcessTemplates(buf + headLen + 6, outLen - 8);
+      readLen = _fillBufferAndProcessTemplates(buf + 6, outLen - 8);
       if (readLen == RESPONSE_TRY_AGAIN) {
-        free(buf);
+        AsyncWebSendBuffers::release(buf);
         return 0;
       }
-      outLen = sprintf((char*)buf + headLen, "%04x", readLen) + headLen;
+      outLen = sprintf((char*)buf, "%04x", readLen);
       buf[outLen++] = '\r';
       buf[outLen++] = '\n';
       outLen += readLen;
       buf[outLen++] = '\r';
       buf[outLen++] = '\n';
     } else {
-      readLen = _fillBufferAndProcessTemplates(buf + headLen, outLen);
+      readLen = _fillBufferAndProcessTemplates(buf, outLen);
       if (readLen == RESPONSE_TRY_AGAIN) {
-        free(buf);
+        AsyncWebSendBuffers::release(buf);
         return 0;
       }
-      outLen = readLen + headLen;
+      outLen = readLen;
     }
 
+    // both parts are copied into the socket buffer, so the buffer can be reused right away
+    size_t written = 0;
     if (headLen) {
+      written += request->client()->add(_head.c_str() + _headWritten, headLen);
       _head = emptyString;
+      _headWritten = 0;
     }
-
     if (outLen) {
-      _writtenLength += request->client()->write((const char*)buf, outLen);
-      _in_flight += outLen;
-      --_in_flight_credit; // take a credit
+      written += request->client()->add((const char*)buf, outLen);
     }
+    AsyncWebSendBuffers::release(buf);
 
-    if (_chunked) {
-      _sentLength += readLen;
-    } else {
-      _sentLength += outLen - headLen;
+    if (written) {
+      request->client()->send();
+      _writtenLength += written;
+      _in_flight += written;
+      --_in_flight_credit; // take a credit
     }
 
-    free(buf);
+    _sentLength += readLen;
 
-    if ((_chunked && readLen == 0) || (!_sendContentLength && outLen == 0) || (!_chunked && _sentLength == _contentLength)) {
+    if ((_chunked && readLen == 0) || (!_sendContentLength && written == 0) || (!_chunked && _sentLength == _contentLength)) {
       _state = RESPONSE_WAIT_ACK;
     }
-    return outLen;
+    return written;
 
   } else if (_state == RESPONSE_WAIT_ACK) {
     if (!_sendContentLength || _ackedLength >= _writtenLength) {
@@ -585,53 +908,53 @@ size_t AsyncAbstractResponse::_fillBufferAndProcessTemplates(uint8_t* data, size
  * File Response
  * */
 
-void AsyncFileResponse::_setContentTypeFromPath(const String& path) {
+String AsyncFileResponse::contentTypeFromPath(const String& path) {
 #if HAVE_EXTERN_GET_Content_Type_FUNCTION
   #ifndef ESP8266
   extern const char* getContentType(const String& path);
   #else
   extern const __FlashStringHelper* getContentType(const String& path);
   #endif
-  _contentType = getContentType(path);
+  return String(getContentType(path));
 #else
   if (path.endsWith(T__html))
-    _contentType = T_text_html;
+    return T_text_html;
   else if (path.endsWith(T__htm))
-    _contentType = T_text_html;
+    return T_text_html;
   else if (path.endsWith(T__css))
-    _contentType = T_text_css;
+    return T_text_css;
   else if (path.endsWith(T__json))
-    _contentType = T_application_json;
+    return T_application_json;
   else if (path.endsWith(T__js))
-    _contentType = T_application_javascript;
+    return T_application_javascript;
   else if (path.endsWith(T__png))
-    _contentType = T_image_png;
+    return T_image_png;
   else if (path.endsWith(T__gif))
-    _contentType = T_image_gif;
+    return T_image_gif;
   else if (path.endsWith(T__jpg))
-    _contentType = T_image_jpeg;
+    return T_image_jpeg;
   else if (path.endsWith(T__ico))
-    _contentType = T_image_x_icon;
+    return T_image_x_icon;
   else if (path.endsWith(T__svg))
-    _contentType = T_image_svg_xml;
+    return T_image_svg_xml;
   else if (path.endsWith(T__eot))
-    _contentType = T_font_eot;
+    return T_font_eot;
   else if (path.endsWith(T__woff))
-    _contentType = T_font_woff;
+    return T_font_woff;
   else if (path.endsWith(T__woff2))
-    _contentType = T_font_woff2;
+    return T_font_woff2;
   else if (path.endsWith(T__ttf))
-    _contentType = T_font_ttf;
+    return T_font_ttf;
   else if (path.endsWith(T__xml))
-    _contentType = T_text_xml;
+    return T_text_xml;
   else if (path.endsWith(T__pdf))
-    _contentType = T_application_pdf;
+    return T_application_pdf;
   else if (path.endsWith(T__zip))
-    _contentType = T_application_zip;
+    return T_application_zip;
   else if (path.endsWith(T__gz))
-    _contentType = T_application_x_gzip;
+    return T_application_x_gzip;
   else
-    _contentType = T_text_plain;
+    return T_text_plain;
 #endif
 }
 
@@ -768,6 +1091,63 @@ size_t AsyncChunkedResponse::_fillBuffer(uint8_t* data, size_t len) {
   return ret;
 }
 
+/*
+ * Template Response
+ * */
+
+size_t AsyncTemplateWriter::write(const uint8_t* data, size_t len) {
+  size_t from = _position;
+  _position += len;
+  if (_position <= _skip)
+    return len;
+  size_t n = len;
+  if (from < _skip) {
+    data += _skip - from;
+    n -= _skip - from;
+  }
+  if (n > _space - _length)
+    n = _space - _length;
+  memcpy(_buf + _length, data, n);
+  _length += n;
+  return len;
+}
+
+AsyncTemplateResponse::AsyncTemplateResponse(int code, const char* contentType, const AsyncWebTemplate& tpl, AwsTemplateRenderer renderer, bool chunked)
+    : _template(tpl), _renderer(renderer), _segment(0), _offset(0) {
+  _code = code;
+  _contentType = contentType;
+  _contentLength = 0;
+  _sendContentLength = false;
+  _chunked = chunked;
+}
+
+size_t AsyncTemplateResponse::_fillBuffer(uint8_t* data, size_t len) {
+  const std::vector<AsyncWebTemplate::Segment>& segments = _template.segments();
+  size_t filled = 0;
+  while (filled < len && _segment < segments.size()) {
+    const AsyncWebTemplate::Segment& segment = segments[_segment];
+    if (segment.id < 0) {
+      size_t n = std::min(segment.length - _offset, len - filled);
+      memcpy_P(data + filled, segment.data + _offset, n);
+      filled += n;
+      _offset += n;
+      if (_offset < segment.length)
+        break;
+    } else if (_renderer) {
+      AsyncTemplateWriter out(data + filled, len - filled, _offset);
+      _renderer(segment.id, out);
+      filled += out.length();
+      if (out.full()) {
+        _offset += out.length();
+        break;
+      }
+    }
+    _segment++;
+    _offset = 0;
+  }
+  return filled;
+}
+
 /*
  * Progmem Response
  * */
@@ -0,0 +1,173 @@
+/*
+  Asynchronous WebServer library for Espressif MCUs
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+  This file is part of the esp8266 core for Arduino environment.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+#include "ESPAsyncWebServer.h"
+
+uint32_t AsyncWebRouter::_version = 0;
+
+void AsyncWebRouter::clear() {
+  _routes.clear();
+  _nodes.clear();
+  _fallback.clear();
+  _built = false;
+}
+
+void AsyncWebRouter::build(const std::list<std::unique_ptr<AsyncWebHandler>>& handlers) {
+  clear();
+  _routes.reserve(handlers.size());
+  _nodes.emplace_back();
+
+  for (auto& h : handlers) {
+    Route route;
+    String uri;
+    route.handler = h.get();
+    route.methods = HTTP_ANY;
+    route.match = h->routeKey(uri, route.methods);
+
+    uint16_t index = _routes.size();
+    _routes.push_back(route);
+    if (route.match == ROUTE_NONE)
+      _fallback.push_back(index);
+    else
+      _insert(uri, index);
+  }
+
+  _built = true;
+  _builtVersion = _version;
+}
+
+void AsyncWebRouter::_insert(const String& uri, uint16_t route) {
+  uint16_t node = 0;
+  size_t pos = 0;
+
+  while (pos < uri.length()) {
+    // _nodes may grow below: only keep indexes across the loop
+    int child = -1;
+    for (uint16_t c : _nodes[node].children) {
+      if (_nodes[c].label[0] == uri[pos]) {
+        child = c;
+        break;
+      }
+    }
+
+    if (child < 0) {
+      Node leaf;
+      leaf.label = uri.substring(pos);
+      _nodes.push_back(leaf);
+      _nodes[node].children.push_back(_nodes.size() - 1);
+      node = _nodes.size() - 1;
+      break;
+    }
+
+    const String& label = _nodes[child].label;
+    size_t common = 1;
+    while (common < label.length() && pos + common < uri.length() && label[common] == uri[pos + common])
+      common++;
+
+    if (common < label.length()) {
+      // Split the edge: node -> middle ("common" chars) -> child (the rest)
+      Node middle;
+      middle.label = label.substring(0, common);
+      middle.children.push_back(child);
+      _nodes[child].label = _nodes[child].label.substring(common);
+      _nodes.push_back(middle);
+      uint16_t m = _nodes.size() - 1;
+      std::replace(_nodes[node].children.begin(), _nodes[node].children.end(), (uint16_t)child, m);
+      child = m;
+    }
+
+    node = child;
+    pos += common;
+  }
+
+  // Routes are inserted in registration order, so each node's list stays sorted
+  _nodes[node].routes.push_back(route);
+}
+
+// Returns the first route registered after "after" that may handle url and method, or -1.
+int AsyncWebRouter::_next(const String& url, WebRequestMethodComposite method, int after) const {
+  int best = -1;
+
+  for (uint16_t r : _fallback) {
+    if (r > after) {
+      best = r;
+      break;
+    }
+  }
+
+  const char* s = url.c_str();
+  size_t len = url.length();
+  size_t pos = 0;
+  uint16_t node = 0;
+
+  while (true) {
+    const Node& n = _nodes[node];
+    bool atEnd = pos == len;
+    bool atSegment = atEnd || s[pos] == '/';
+
+    for (uint16_t r : n.routes) {
+      if (r <= after)
+        continue;
+      if (best >= 0 && r >= best)
+        break;
+      const Route& route = _routes[r];
+      if (!(route.methods & method))
+        continue;
+      if (route.match == ROUTE_PREFIX || (route.match == ROUTE_SEGMENT && atSegment) || (route.match == ROUTE_EXACT && atEnd)) {
+        best = r;
+        break;
+      }
+    }
+
+    if (atEnd)
+      break;
+
+    int child = -1;
+    for (uint16_t c : n.children) {
+      const String& label = _nodes[c].label;
+      if (label[0] == s[pos]) {
+        if (label.length() <= len - pos && memcmp(label.c_str(), s + pos, label.length()) == 0)
+          child = c;
+        break;
+      }
+    }
+    if (child < 0)
+      break;
+
+    pos += _nodes[child].label.length();
+    node = child;
+  }
+
+  return best;
+}
+
+AsyncWebHandler* AsyncWebRouter::find(AsyncWebServerRequest* request) const {
+  const String& url = request->url();
+  WebRequestMethodComposite method = request->method();
+
+  int r = -1;
+  while ((r = _next(url, method, r)) >= 0) {
+    AsyncWebHandler* h = _routes[r].handler;
+    if (h->filter(request) && h->canHandle(request))
+      return h;
+  }
+
+  return nullptr;
+}
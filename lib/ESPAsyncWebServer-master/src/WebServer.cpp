@@ -101,6 +101,7 @@ AsyncWebRewrite& AsyncWebServer::rewrite(const char* from, const char* to) {
 
 AsyncWebHandler& AsyncWebServer::addHandler(AsyncWebHandler* handler) {
   _handlers.emplace_back(handler);
+  _router.clear();
   return *(_handlers.back().get());
 }
 
@@ -108,6 +109,7 @@ bool AsyncWebServer::removeHandler(AsyncWebHandler* handler) {
   for (auto i = _handlers.begin(); i != _handlers.end(); ++i) {
     if (i->get() == handler) {
       _handlers.erase(i);
+      _router.clear();
       return true;
     }
   }
@@ -115,6 +117,8 @@ bool AsyncWebServer::removeHandler(AsyncWebHandler* handler) {
 }
 
 void AsyncWebServer::begin() {
+  // Handlers added after begin() trigger a rebuild on the next request
+  _router.build(_handlers);
   _server.setNoDelay(true);
   _server.begin();
 }
@@ -147,14 +151,11 @@ void AsyncWebServer::_rewriteRequest(AsyncWebServerRequest* request) {
 }
 
 void AsyncWebServer::_attachHandler(AsyncWebServerRequest* request) {
-  for (auto& h : _handlers) {
-    if (h->filter(request) && h->canHandle(request)) {
-      request->setHandler(h.get());
-      return;
-    }
-  }
+  if (!_router.built())
+    _router.build(_handlers);
 
-  request->setHandler(_catchAllHandler);
+  AsyncWebHandler* handler = _router.find(request);
+  request->setHandler(handler ? handler : _catchAllHandler);
 }
 
 AsyncCallbackWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody) {
@@ -189,6 +190,7 @@ void AsyncWebServer::onRequestBody(ArBodyHandlerFunction fn) {
 void AsyncWebServer::reset() {
   _rewrites.clear();
   _handlers.clear();
+  _router.clear();
 
   if (_catchAllHandler != NULL) {
     _catchAllHandler->onRequest(NULL);
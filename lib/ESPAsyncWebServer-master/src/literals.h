@@ -8,6 +8,7 @@ namespace asyncsrv {
   static constexpr const char* T_100_CONTINUE = "100-continue";
   static constexpr const char* T_13 = "13";
   static constexpr const char* T_ACCEPT = "accept";
+  static constexpr const char* T_Accept_Encoding = "accept-encoding";
   static constexpr const char* T_Accept_Ranges = "accept-ranges";
   static constexpr const char* T_app_xform_urlencoded = "application/x-www-form-urlencoded";
   static constexpr const char* T_AUTH = "authorization";
@@ -16,6 +17,7 @@ namespace asyncsrv {
   static constexpr const char* T_BASIC_REALM = "basic realm=\"";
   static constexpr const char* T_BEARER = "bearer";
   static constexpr const char* T_BODY = "body";
+  static constexpr const char* T_bytes = "bytes";
   static constexpr const char* T_Cache_Control = "cache-control";
   static constexpr const char* T_chunked = "chunked";
   static constexpr const char* T_close = "close";
@@ -24,6 +26,7 @@ namespace asyncsrv {
   static constexpr const char* T_Content_Disposition = "content-disposition";
   static constexpr const char* T_Content_Encoding = "content-encoding";
   static constexpr const char* T_Content_Length = "content-length";
+  static constexpr const char* T_Content_Range = "content-range";
   static constexpr const char* T_Content_Type = "content-type";
   static constexpr const char* T_Cookie = "cookie";
   static constexpr const char* T_CORS_ACAC = "access-control-allow-credentials";
@@ -45,6 +48,7 @@ namespace asyncsrv {
   static constexpr const char* T_HTTP_1_0 = "HTTP/1.0";
   static constexpr const char* T_HTTP_100_CONT = "HTTP/1.1 100 Continue\r\n\r\n";
   static constexpr const char* T_id__ = "id: ";
+  static constexpr const char* T_IF_RANGE = "if-range";
   static constexpr const char* T_IMS = "if-modified-since";
   static constexpr const char* T_INM = "if-none-match";
   static constexpr const char* T_keep_alive = "keep-alive";
@@ -60,6 +64,7 @@ namespace asyncsrv {
   static constexpr const char* T_none = "none";
   static constexpr const char* T_opaque = "opaque";
   static constexpr const char* T_qop = "qop";
+  static constexpr const char* T_RANGE = "range";
   static constexpr const char* T_realm = "realm";
   static constexpr const char* T_realm__ = "realm=\"";
   static constexpr const char* T_response = "response";
@@ -68,6 +73,9 @@ namespace asyncsrv {
   static constexpr const char* T_nn = "\n\n";
   static constexpr const char* T_rn = "\r\n";
   static constexpr const char* T_rnrn = "\r\n\r\n";
+  static constexpr const char* T_SEC_WS_KEY = "sec-websocket-key";
+  static constexpr const char* T_SEC_WS_PROTOCOL = "sec-websocket-protocol";
+  static constexpr const char* T_SEC_WS_VERSION = "sec-websocket-version";
   static constexpr const char* T_Transfer_Encoding = "transfer-encoding";
   static constexpr const char* T_TRUE = "true";
   static constexpr const char* T_UPGRADE = "upgrade";
@@ -0,0 +1,57 @@
+// Request time against the number of routes: handlers in the route table, and the same number of
+// handlers the router cannot index, which are asked one by one as before the table. See README.md.
+#include "AsyncTCP.h"
+#include "ESPAsyncWebServer.h"
+
+#include <chrono>
+
+// Matches like an exact uri handler, but without telling the router how
+class ScannedHandler : public AsyncWebHandler {
+  public:
+    ScannedHandler(const String& uri) : _uri(uri) {}
+    bool canHandle(AsyncWebServerRequest* request) const override { return request->method() == HTTP_GET && request->url() == _uri; }
+    void handleRequest(AsyncWebServerRequest* request) override { request->send(200); }
+
+  private:
+    String _uri;
+};
+
+static double nsPerRequest(AsyncWebServer& server, int routes) {
+  server.begin();
+  std::string request = "GET /route/" + std::to_string(routes - 1) + " HTTP/1.1\r\nHost: esp\r\n\r\n";
+  AsyncClient* c = AsyncServer::connect();
+  const int requests = 200000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < requests; i++) {
+    // kept alive: each answered request hands the connection over to the next one, up to ASYNCWEBSERVER_KEEPALIVE_MAX_REQUESTS
+    c->receive(request.data(), request.size());
+    c->ackAll();
+    if (c->output.find("connection: close") != std::string::npos) {
+      c->poll(); // the server closes a finished response on the next poll
+      c->disconnect();
+      c = AsyncServer::connect();
+    }
+    c->output.clear();
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / requests;
+  c->disconnect();
+  return ns;
+}
+
+int main() {
+  printf("routes  scanned  route table  (ns/request for the last route)\n");
+  for (int routes : {1, 10, 50, 200}) {
+    AsyncWebServer scanned(80);
+    for (int i = 0; i < routes; i++)
+      scanned.addHandler(new ScannedHandler(("/route/" + std::to_string(i)).c_str()));
+    double scannedNs = nsPerRequest(scanned, routes);
+
+    AsyncWebServer indexed(80);
+    for (int i = 0; i < routes; i++)
+      indexed.on(("/route/" + std::to_string(i)).c_str(), HTTP_GET, [](AsyncWebServerRequest* request) { request->send(200); });
+    double indexedNs = nsPerRequest(indexed, routes);
+
+    printf("%6d  %7.0f  %11.0f\n", routes, scannedNs, indexedNs);
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+// Throughput of masked client frames through AsyncWebSocketClient::_onData, in MB/s of unmasked payload.
+// Build with optimisations, see README.md.
+#include "AsyncTCP.h"
+#include "AsyncWebSocket.h"
+#include "ESPAsyncWebServer.h"
+
+#include <chrono>
+#include <vector>
+
+static size_t receivedBytes = 0;
+
+static std::string frame(const std::string& payload, const uint8_t mask[4]) {
+  std::string f = "\x82";
+  size_t len = payload.size();
+  if (len < 126) {
+    f += (char)(0x80 | len);
+  } else {
+    f += (char)(0x80 | 126);
+    f += (char)(len >> 8);
+    f += (char)len;
+  }
+  f.append((const char*)mask, 4);
+  for (size_t i = 0; i < len; i++)
+    f += (char)(payload[i] ^ mask[i % 4]);
+  return f;
+}
+
+int main() {
+  AsyncWebServer server(80);
+  AsyncWebSocket* ws = new AsyncWebSocket("/ws"); // owned by the server
+  ws->onEvent([](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    if (type == WS_EVT_DATA)
+      receivedBytes += len;
+  });
+  server.addHandler(ws);
+  server.begin();
+
+  AsyncClient* c = AsyncServer::connect();
+  std::string upgrade = "GET /ws HTTP/1.1\r\nHost: esp\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  c->receive(upgrade.data(), upgrade.size());
+  c->ackAll();
+
+  const uint8_t mask[4] = {0x71, 0x5e, 0x3c, 0x9a};
+  // small frames in one segment each, and large ones spread over 1460 byte segments (the usual MSS)
+  for (size_t len : {125, 1400, 11200}) {
+    std::string f = frame(std::string(len, 'x'), mask);
+    std::vector<std::vector<char>> segments;
+    for (size_t o = 0; o < f.size(); o += 1460)
+      segments.emplace_back(f.begin() + o, f.begin() + std::min(f.size(), o + 1460));
+    const size_t frames = 200000000 / f.size();
+    receivedBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames; i++) {
+      // _onData unmasks in place: start each frame from the masked copy
+      for (size_t s = 0; s < segments.size(); s++) {
+        std::vector<char> segment = segments[s];
+        segment.push_back(0);
+        c->receive(segment.data(), segment.size() - 1);
+      }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%5zu byte frames: %7.1f MB/s\n", len, receivedBytes / seconds / 1e6);
+  }
+
+  c->disconnect();
+  return 0;
+}
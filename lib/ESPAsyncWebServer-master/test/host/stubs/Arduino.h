@@ -0,0 +1,226 @@
+// Host stand-in for the parts of the Arduino core the library uses, see ../README.md
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PGM_P               const char*
+#define PSTR(s)             (s)
+#define strlen_P            strlen
+#define strcpy_P            strcpy
+#define strncpy_P           strncpy
+#define strcmp_P            strcmp
+#define strncmp_P           strncmp
+#define memcpy_P            memcpy
+#define snprintf_P          snprintf
+#define sprintf_P           sprintf
+#define pgm_read_byte(p)    (*(const uint8_t*)(p))
+#define __unused            __attribute__((unused))
+#define HEX                 16
+#define DEC                 10
+#define log_e(...)
+#define log_w(...)
+#define log_i(...)
+#define log_d(...)
+#define log_v(...)
+
+class __FlashStringHelper;
+#define F(s)     (reinterpret_cast<const __FlashStringHelper*>(s))
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+
+unsigned long millis();
+unsigned long micros();
+void yield();
+void delay(unsigned long ms);
+uint32_t esp_random();
+
+// Arduino String on top of std::string, with only the members the library calls
+class String {
+  public:
+    String(const char* c = "") : s(c ? c : "") {}
+    String(const char* c, unsigned n) : s(c, n) {}
+    String(const __FlashStringHelper* c) : s((const char*)c) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(int v, unsigned char base = 10) : s(std::to_string(v)) {}
+    explicit String(unsigned v, unsigned char base = 10) : s(std::to_string(v)) {}
+    explicit String(long v, unsigned char base = 10) : s(std::to_string(v)) {}
+    explicit String(unsigned long v, unsigned char base = 10) : s(std::to_string(v)) {}
+    explicit String(long long v, unsigned char base = 10) : s(std::to_string(v)) {}
+    explicit String(unsigned long long v, unsigned char base = 10) : s(std::to_string(v)) {}
+    explicit String(float v, unsigned char decimals = 2) : s(std::to_string(v)) {}
+    explicit String(double v, unsigned char decimals = 2) : s(std::to_string(v)) {}
+
+    String& operator=(const char* c) {
+      s = c ? c : "";
+      return *this;
+    }
+    template <typename T>
+    String& operator+=(const T& v) {
+      concat(v);
+      return *this;
+    }
+
+    unsigned int length() const { return s.size(); }
+    const char* c_str() const { return s.c_str(); }
+    char* begin() { return &s[0]; }
+    char* end() { return &s[0] + s.size(); }
+    const char* begin() const { return s.data(); }
+    const char* end() const { return s.data() + s.size(); }
+    bool reserve(unsigned n) {
+      s.reserve(n);
+      return true;
+    }
+    void clear() { s.clear(); }
+
+    bool concat(const String& o) { return s.append(o.s), true; }
+    bool concat(const char* c) { return s.append(c), true; }
+    bool concat(const char* c, unsigned n) { return s.append(c, n), true; }
+    bool concat(const __FlashStringHelper* c) { return s.append((const char*)c), true; }
+    bool concat(char c) { return s.push_back(c), true; }
+    bool concat(unsigned char v) { return s.append(std::to_string(v)), true; }
+    bool concat(int v) { return s.append(std::to_string(v)), true; }
+    bool concat(unsigned v) { return s.append(std::to_string(v)), true; }
+    bool concat(long v) { return s.append(std::to_string(v)), true; }
+    bool concat(unsigned long v) { return s.append(std::to_string(v)), true; }
+    bool concat(long long v) { return s.append(std::to_string(v)), true; }
+    bool concat(unsigned long long v) { return s.append(std::to_string(v)), true; }
+
+    char operator[](unsigned i) const { return s[i]; }
+    char& operator[](unsigned i) { return s[i]; }
+    char charAt(unsigned i) const { return s[i]; }
+    void setCharAt(unsigned i, char c) { s[i] = c; }
+
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* c) const { return s == c; }
+    bool operator!=(const String& o) const { return s != o.s; }
+    bool operator!=(const char* c) const { return s != c; }
+    bool operator<(const String& o) const { return s < o.s; }
+    bool equals(const String& o) const { return s == o.s; }
+    bool equals(const char* c) const { return s == c; }
+    bool equalsIgnoreCase(const String& o) const { return strcasecmp(s.c_str(), o.s.c_str()) == 0; }
+    bool startsWith(const String& p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+    bool startsWith(const String& p, unsigned off) const { return off <= s.size() && s.compare(off, p.s.size(), p.s) == 0; }
+    bool endsWith(const String& p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+
+    int indexOf(char c, unsigned from = 0) const { return _pos(s.find(c, from)); }
+    int indexOf(const String& c, unsigned from = 0) const { return _pos(s.find(c.s, from)); }
+    int lastIndexOf(char c) const { return _pos(s.rfind(c)); }
+    int lastIndexOf(const String& c) const { return _pos(s.rfind(c.s)); }
+    String substring(unsigned from) const { return from > s.size() ? String() : String(s.c_str() + from); }
+    String substring(unsigned from, unsigned to) const {
+      if (from > to)
+        std::swap(from, to);
+      if (from > s.size())
+        return String();
+      return String(s.c_str() + from, std::min<size_t>(to, s.size()) - from);
+    }
+
+    void trim() {
+      size_t a = s.find_first_not_of(" \t\r\n");
+      size_t b = s.find_last_not_of(" \t\r\n");
+      s = a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+    }
+    void toLowerCase() {
+      for (auto& c : s)
+        c = tolower(c);
+    }
+    void toUpperCase() {
+      for (auto& c : s)
+        c = toupper(c);
+    }
+    void replace(const String& from, const String& to) {
+      for (size_t p = 0; !from.s.empty() && (p = s.find(from.s, p)) != std::string::npos; p += to.s.size())
+        s.replace(p, from.s.size(), to.s);
+    }
+    void replace(char from, char to) { std::replace(s.begin(), s.end(), from, to); }
+    void remove(unsigned i, unsigned n = 1) {
+      if (i < s.size())
+        s.erase(i, n);
+    }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+    double toDouble() const { return atof(s.c_str()); }
+    explicit operator bool() const { return true; }
+
+  private:
+    std::string s;
+    static int _pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+};
+
+template <typename T>
+String operator+(const String& a, const T& b) {
+  String r(a);
+  r.concat(b);
+  return r;
+}
+inline String operator+(const char* a, const String& b) {
+  String r(a);
+  r.concat(b);
+  return r;
+}
+
+extern const String emptyString;
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t len) {
+      size_t n = 0;
+      while (n < len && write(buffer[n]))
+        n++;
+      return n;
+    }
+    size_t write(const char* buffer, size_t len) { return write((const uint8_t*)buffer, len); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t println(const char* s = "") { return print(s) + print("\r\n"); }
+    size_t println(const String& s) { return print(s) + print("\r\n"); }
+    size_t println(int v) { return print(v) + print("\r\n"); }
+    size_t printf(const char* format, ...);
+    virtual int availableForWrite() { return 0; }
+};
+
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual size_t readBytes(uint8_t* buffer, size_t len) {
+      size_t n = 0;
+      int c;
+      while (n < len && (c = read()) >= 0)
+        buffer[n++] = c;
+      return n;
+    }
+    size_t readBytes(char* buffer, size_t len) { return readBytes((uint8_t*)buffer, len); }
+};
+
+class IPAddress {
+  public:
+    IPAddress(uint32_t address = 0) : _address(address) {}
+    operator uint32_t() const { return _address; }
+    bool operator==(const IPAddress& o) const { return _address == o._address; }
+    bool operator!=(const IPAddress& o) const { return _address != o._address; }
+    String toString() const;
+
+  private:
+    uint32_t _address;
+};
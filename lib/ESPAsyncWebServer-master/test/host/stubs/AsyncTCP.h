@@ -0,0 +1,111 @@
+// Host stand-in for AsyncTCP: a client is driven by the test instead of lwIP, see ../README.md
+#pragma once
+
+#include "Arduino.h"
+#include <string>
+
+#define ASYNC_WRITE_FLAG_COPY 0x01
+#define ASYNC_WRITE_FLAG_MORE 0x02
+#define ASYNC_MAX_ACK_TIME    5000
+
+struct pbuf;
+class AsyncClient;
+
+typedef std::function<void(void*, AsyncClient*)> AcConnectHandler;
+typedef std::function<void(void*, AsyncClient*, size_t len, uint32_t time)> AcAckHandler;
+typedef std::function<void(void*, AsyncClient*, int8_t error)> AcErrorHandler;
+typedef std::function<void(void*, AsyncClient*, void* data, size_t len)> AcDataHandler;
+typedef std::function<void(void*, AsyncClient*, struct pbuf* pb)> AcPacketHandler;
+typedef std::function<void(void*, AsyncClient*, uint32_t time)> AcTimeoutHandler;
+
+class AsyncClient {
+  public:
+    void onConnect(AcConnectHandler cb, void* arg = 0) {}
+    void onDisconnect(AcConnectHandler cb, void* arg = 0) { _disconnect = std::bind(cb, arg, this); }
+    void onAck(AcAckHandler cb, void* arg = 0) { _ack = std::bind(cb, arg, this, std::placeholders::_1, 0); }
+    void onError(AcErrorHandler cb, void* arg = 0) {}
+    void onData(AcDataHandler cb, void* arg = 0) { _data = std::bind(cb, arg, this, std::placeholders::_1, std::placeholders::_2); }
+    void onPacket(AcPacketHandler cb, void* arg = 0) {}
+    void onTimeout(AcTimeoutHandler cb, void* arg = 0) {}
+    void onPoll(AcConnectHandler cb, void* arg = 0) { _poll = std::bind(cb, arg, this); }
+
+    size_t space() const { return 5744; }
+    size_t add(const char* data, size_t size, uint8_t apiflags = ASYNC_WRITE_FLAG_COPY) {
+      output.append(data, size);
+      _unacked += size;
+      return size;
+    }
+    bool send() { return true; }
+    size_t write(const char* data) { return write(data, strlen(data)); }
+    size_t write(const char* data, size_t size, uint8_t apiflags = ASYNC_WRITE_FLAG_COPY) { return add(data, size, apiflags); }
+    bool canSend() const { return !_closed; }
+    void close(bool now = false) { _closed = true; }
+    int8_t abort() { return _closed = true, 0; }
+    bool connected() const { return !_closed; }
+    bool disconnected() const { return _closed; }
+    bool freeable() const { return true; }
+
+    void setRxTimeout(uint32_t timeout) {}
+    uint32_t getRxTimeout() const { return 0; }
+    void setAckTimeout(uint32_t timeout) {}
+    void setNoDelay(bool nodelay) {}
+    IPAddress remoteIP() const { return IPAddress(); }
+    uint16_t remotePort() const { return 0; }
+    IPAddress localIP() const { return IPAddress(); }
+    uint16_t localPort() const { return 0; }
+    void ackLater() {}
+    size_t ack(size_t len) { return len; }
+    void ackPacket(struct pbuf* pb) {}
+
+    // Test side: what the server wrote, and the events lwIP would raise
+    std::string output;
+    // (handlers are copied before the call: the server may replace them, or delete the client, from inside)
+    void receive(const void* data, size_t len) {
+      auto cb = _data;
+      cb(const_cast<void*>(data), len);
+    }
+    void ackAll() {
+      for (int i = 0; i < 100 && _unacked && !_closed; i++) {
+        size_t len = _unacked;
+        _unacked = 0;
+        auto cb = _ack;
+        cb(len);
+      }
+    }
+    void poll() {
+      auto cb = _poll;
+      cb();
+    }
+    void disconnect() {
+      auto cb = _disconnect;
+      cb();
+    }
+
+  private:
+    std::function<void()> _disconnect;
+    std::function<void()> _poll;
+    std::function<void(size_t)> _ack;
+    std::function<void(void*, size_t)> _data;
+    size_t _unacked = 0;
+    bool _closed = false;
+};
+
+class AsyncServer {
+  public:
+    AsyncServer(uint16_t port) {}
+    void onClient(AcConnectHandler cb, void* arg) { _client = std::bind(cb, arg, std::placeholders::_1); }
+    void begin() { _running = this; }
+    void end() { _running = nullptr; }
+    void setNoDelay(bool nodelay) {}
+
+    // Test side: a new connection to the server that began last
+    static AsyncClient* connect() {
+      AsyncClient* c = new AsyncClient();
+      _running->_client(c);
+      return c;
+    }
+
+  private:
+    std::function<void(AsyncClient*)> _client;
+    static AsyncServer* _running;
+};
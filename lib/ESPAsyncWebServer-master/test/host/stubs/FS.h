@@ -0,0 +1,43 @@
+// Host stand-in for the Arduino FS: no files, enough for the static handler to link
+#pragma once
+
+#include "Arduino.h"
+#include <memory>
+
+namespace fs {
+  enum SeekMode {
+    SeekSet,
+    SeekCur,
+    SeekEnd
+  };
+
+  class File : public Stream {
+    public:
+      size_t write(uint8_t c) override { return 0; }
+      size_t write(const uint8_t* buffer, size_t len) override { return 0; }
+      int available() override { return 0; }
+      int read() override { return -1; }
+      int peek() override { return -1; }
+      size_t read(uint8_t* buffer, size_t len) { return 0; }
+      bool seek(uint32_t pos, SeekMode mode = SeekSet) { return false; }
+      size_t size() const { return 0; }
+      size_t position() const { return 0; }
+      void close() {}
+      operator bool() const { return false; }
+      bool isDirectory() { return false; }
+      const char* name() const { return ""; }
+      const char* path() const { return ""; }
+      time_t getLastWrite() { return 0; }
+  };
+
+  class FS {
+    public:
+      File open(const char* path, const char* mode, bool create = false) { return File(); }
+      File open(const String& path, const char* mode, bool create = false) { return File(); }
+      bool exists(const char* path) { return false; }
+      bool exists(const String& path) { return false; }
+  };
+}
+
+using fs::File;
+using fs::FS;
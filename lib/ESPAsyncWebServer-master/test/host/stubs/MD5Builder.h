@@ -0,0 +1,14 @@
+// Digests are not checked by the host tests: fixed outputs of the right size
+#pragma once
+#include "Arduino.h"
+
+class MD5Builder {
+  public:
+    void begin() {}
+    void add(const uint8_t* data, size_t len) {}
+    void add(const char* data) {}
+    void add(const String& data) {}
+    void calculate() {}
+    void getChars(char* output) { strcpy(output, "00000000000000000000000000000000"); }
+    String toString() { return String("00000000000000000000000000000000"); }
+};
@@ -0,0 +1,12 @@
+// Digests are not checked by the host tests: fixed outputs of the right size
+#pragma once
+#include "Arduino.h"
+
+class SHA1Builder {
+  public:
+    void begin() {}
+    void add(const uint8_t* data, size_t len) {}
+    void add(const char* data) {}
+    void calculate() {}
+    void getBytes(uint8_t* output) { memset(output, 0, 20); }
+};
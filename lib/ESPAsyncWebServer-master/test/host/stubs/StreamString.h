@@ -0,0 +1,11 @@
+#pragma once
+#include "Arduino.h"
+
+class StreamString : public Stream, public String {
+  public:
+    size_t write(uint8_t c) override { return concat((char)c), 1; }
+    size_t write(const uint8_t* buffer, size_t len) override { return concat((const char*)buffer, len), len; }
+    int available() override { return length(); }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
@@ -0,0 +1,8 @@
+#pragma once
+#include "Arduino.h"
+
+class WiFiClass {
+  public:
+    IPAddress localIP() { return IPAddress(); }
+};
+extern WiFiClass WiFi;
@@ -0,0 +1,12 @@
+// Not a real encoder: the host tests do not check Sec-WebSocket-Accept
+#pragma once
+
+typedef struct {
+  int unused;
+} base64_encodestate;
+
+inline void base64_init_encodestate(base64_encodestate* state) {}
+inline int base64_encode_block(const char* plaintext, int length, char* code, base64_encodestate* state) { return 0; }
+inline int base64_encode_blockend(char* code, base64_encodestate* state) { return *code = 0, 0; }
+inline int base64_encode_chars(const char* plaintext, int length, char* code) { return *code = 0, 0; }
+inline int base64_encode_expected_len(int length) { return (length + 2) / 3 * 4; }
@@ -0,0 +1,42 @@
+// Definitions for the host stand-ins
+#include "Arduino.h"
+#include "AsyncTCP.h"
+#include "WiFi.h"
+
+#include <chrono>
+
+const String emptyString;
+WiFiClass WiFi;
+AsyncServer* AsyncServer::_running = nullptr;
+
+unsigned long millis() {
+  static auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros() {
+  return millis() * 1000;
+}
+
+void yield() {}
+
+void delay(unsigned long ms) {}
+
+uint32_t esp_random() {
+  return rand();
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address & 0xFF, (_address >> 8) & 0xFF, (_address >> 16) & 0xFF, _address >> 24);
+  return String(buf);
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  return len < 0 ? 0 : write((const uint8_t*)buf, std::min<size_t>(len, sizeof(buf) - 1));
+}
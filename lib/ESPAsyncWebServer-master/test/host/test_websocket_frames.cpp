@@ -0,0 +1,158 @@
+// WebSocket frames split across TCP segments at every offset: extended 126/127 lengths, a mask in its own
+// segment, and a random stream delivered 1 byte at a time up to whole frames. See README.md to build and run.
+#include "AsyncTCP.h"
+#include "AsyncWebSocket.h"
+#include "ESPAsyncWebServer.h"
+
+#include <vector>
+
+static std::string received;
+static size_t pings = 0;
+static int failures = 0;
+static int checks = 0;
+
+// A client frame: always masked, with the shortest length encoding
+static std::string frame(uint8_t opcode, const std::string& payload, uint32_t mask) {
+  std::string f(1, (char)(0x80 | opcode));
+  size_t len = payload.size();
+  if (len < 126) {
+    f += (char)(0x80 | len);
+  } else if (len < 65536) {
+    f += (char)(0x80 | 126);
+    f += (char)(len >> 8);
+    f += (char)len;
+  } else {
+    f += (char)(0x80 | 127);
+    for (int i = 7; i >= 0; i--)
+      f += (char)((uint64_t)len >> (8 * i));
+  }
+  uint8_t m[4] = {(uint8_t)mask, (uint8_t)(mask >> 8), (uint8_t)(mask >> 16), (uint8_t)(mask >> 24)};
+  f.append((const char*)m, 4);
+  for (size_t i = 0; i < len; i++)
+    f += (char)(payload[i] ^ m[i % 4]);
+  return f;
+}
+
+static size_t headerLength(size_t payloadLength) {
+  return payloadLength < 126 ? 6 : payloadLength < 65536 ? 8 : 14;
+}
+
+static std::string payload(size_t len) {
+  std::string p(len, 0);
+  for (auto& c : p)
+    c = 'a' + rand() % 26;
+  return p;
+}
+
+// Delivers the stream cut at the given offsets, like lwIP hands over pbufs
+static void deliver(AsyncClient* c, const std::string& stream, const std::vector<size_t>& cuts) {
+  size_t start = 0;
+  for (size_t i = 0; i <= cuts.size(); i++) {
+    size_t end = i < cuts.size() ? cuts[i] : stream.size();
+    // one spare byte: the parser looks at the byte after the payload to terminate text frames
+    std::vector<char> segment(stream.begin() + start, stream.begin() + end);
+    segment.push_back(0);
+    if (end > start)
+      c->receive(segment.data(), end - start);
+    start = end;
+  }
+}
+
+static void deliverInSegments(AsyncClient* c, const std::string& stream, size_t segment) {
+  std::vector<size_t> cuts;
+  for (size_t o = segment; o < stream.size(); o += segment)
+    cuts.push_back(o);
+  deliver(c, stream, cuts);
+}
+
+static void check(bool ok, const char* what, size_t a, size_t b) {
+  checks++;
+  if (!ok) {
+    failures++;
+    printf("FAIL %s (%zu, %zu): received %zu bytes\n", what, a, b, received.size());
+  }
+}
+
+int main() {
+  AsyncWebServer server(80);
+  AsyncWebSocket* ws = new AsyncWebSocket("/ws"); // owned by the server
+  ws->onEvent([](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    if (type == WS_EVT_DATA)
+      received.append((const char*)data, len);
+    else if (type == WS_EVT_PING)
+      pings++;
+  });
+  server.addHandler(ws);
+  server.begin();
+
+  AsyncClient* c = AsyncServer::connect();
+  std::string upgrade = "GET /ws HTTP/1.1\r\nHost: esp\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+  c->receive(upgrade.data(), upgrade.size());
+  c->ackAll();
+  if (c->output.compare(0, 12, "HTTP/1.1 101") != 0 || ws->count() != 1) {
+    printf("FAIL handshake: %s\n", c->output.substr(0, c->output.find('\r')).c_str());
+    return 1;
+  }
+
+  // Every segment size from 1 byte, around each length encoding; a second frame checks the parser stays in step
+  for (size_t len : {0, 1, 5, 125, 126, 127, 1000, 65535, 65536, 70000}) {
+    std::string p = payload(len), q = payload(7);
+    std::string stream = frame(2, p, rand()) + frame(2, q, rand());
+    for (size_t segment = 1; segment <= 16; segment++) {
+      if (len >= 65535 && segment > 3 && segment != 16)
+        continue; // the long frames only need a few sizes to cross the header at each offset
+      received.clear();
+      deliverInSegments(c, stream, segment);
+      check(received == p + q, "segments", len, segment);
+    }
+    received.clear();
+    deliverInSegments(c, stream, stream.size());
+    check(received == p + q, "whole", len, stream.size());
+  }
+
+  // Header cut at each byte, the rest of the frame in one piece
+  for (size_t len : {3, 126, 300, 65536}) {
+    std::string p = payload(len);
+    std::string f = frame(1, p, rand());
+    for (size_t cut = 1; cut <= headerLength(len); cut++) {
+      received.clear();
+      deliver(c, f, {cut});
+      check(received == p, "header cut", len, cut);
+    }
+  }
+
+  // The mask alone in its own segment, as Safari sends it, also for an empty payload
+  for (size_t len : {0, 4, 126, 65536}) {
+    std::string p = payload(len);
+    std::string f = frame(2, p, 0x5a1f3c07);
+    size_t maskAt = headerLength(len) - 4;
+    received.clear();
+    deliver(c, f, {maskAt, maskAt + 4});
+    check(received == p, "mask segment", len, maskAt);
+  }
+
+  // Random frames with empty pings in between, cut into segments of many sizes
+  srand(11);
+  std::string stream, expect;
+  size_t expectPings = 0;
+  for (int i = 0; i < 300; i++) {
+    std::string p = payload(rand() % 5 == 0 ? 126 + rand() % 70000 : rand() % 130);
+    stream += frame(rand() % 2 ? 1 : 2, p, rand());
+    expect += p;
+    if (i % 37 == 0) {
+      stream += frame(9, "", rand());
+      expectPings++;
+    }
+  }
+  for (size_t segment : {1, 2, 3, 5, 7, 13, 100, 1460, 100000}) {
+    received.clear();
+    pings = 0;
+    deliverInSegments(c, stream, segment);
+    check(received == expect && pings == expectPings, "random stream", stream.size(), segment);
+  }
+
+  c->disconnect();
+  printf("%d of %d checks passed\n", checks - failures, checks);
+  return failures ? 1 : 0;
+}
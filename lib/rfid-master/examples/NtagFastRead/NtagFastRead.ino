@@ -0,0 +1,112 @@
+/*
+ * --------------------------------------------------------------------------------------------------------------------
+ * Example sketch/program comparing NTAG21x FAST_READ with MIFARE_Read for a 128 byte payload.
+ * --------------------------------------------------------------------------------------------------------------------
+ * This is a MFRC522 library example; for further details and other examples see: https://github.com/miguelbalboa/rfid
+ * 
+ * Reads PAYLOAD_PAGES pages starting at PAYLOAD_START_PAGE from a NTAG213/215/216 twice: once with repeated
+ * MIFARE_Read() calls (4 pages each) and once with NTAG_ReadPages() (FAST_READ, 15 pages each), prints the
+ * time both took and checks that both returned the same data. Also prints the originality signature read
+ * with NTAG_ReadSignature().
+ * 
+ * @license Released into the public domain.
+ * 
+ * Typical pin layout used:
+ * -----------------------------------------------------------------------------------------
+ *             MFRC522      Arduino       Arduino   Arduino    Arduino          Arduino
+ *             Reader/PCD   Uno/101       Mega      Nano v3    Leonardo/Micro   Pro Micro
+ * Signal      Pin          Pin           Pin       Pin        Pin              Pin
+ * -----------------------------------------------------------------------------------------
+ * RST/Reset   RST          9             5         D9         RESET/ICSP-5     RST
+ * SPI SS      SDA(SS)      10            53        D10        10               10
+ * SPI MOSI    MOSI         11 / ICSP-4   51        D11        ICSP-4           16
+ * SPI MISO    MISO         12 / ICSP-1   50        D12        ICSP-1           14
+ * SPI SCK     SCK          13 / ICSP-3   52        D13        ICSP-3           15
+ *
+ * More pin layouts for other boards can be found here: https://github.com/miguelbalboa/rfid#pin-layout
+ */
+
+#include <SPI.h>
+#include <MFRC522.h>
+
+#define SS_PIN 10
+#define RST_PIN 9
+
+#define PAYLOAD_START_PAGE 4     // First user memory page of NTAG21x
+#define PAYLOAD_PAGES 32         // 128 bytes
+
+MFRC522 mfrc522(SS_PIN, RST_PIN); // Create MFRC522 instance
+
+void setup() {
+  Serial.begin(9600);   // Initialize serial communications with the PC
+  while (!Serial);      // Do nothing if no serial port is opened (added for Arduinos based on ATMEGA32U4)
+  SPI.begin();          // Init SPI bus
+  mfrc522.PCD_Init();   // Init MFRC522
+  Serial.println(F("Scan a NTAG21x to compare MIFARE_Read and FAST_READ..."));
+}
+
+void loop() {
+  if ( ! mfrc522.PICC_IsNewCardPresent() || ! mfrc522.PICC_ReadCardSerial()) {
+    return;
+  }
+
+  byte slowData[PAYLOAD_PAGES * 4];
+  byte fastData[PAYLOAD_PAGES * 4];
+  byte buffer[18];
+  MFRC522::StatusCode status;
+
+  // Repeated MIFARE_Read: 16 bytes (4 pages) per command
+  unsigned long start = micros();
+  for (byte page = 0; page < PAYLOAD_PAGES; page += 4) {
+    byte size = sizeof(buffer);
+    status = mfrc522.MIFARE_Read(PAYLOAD_START_PAGE + page, buffer, &size);
+    if (status != MFRC522::STATUS_OK) {
+      Serial.print(F("MIFARE_Read() failed: "));
+      Serial.println(mfrc522.GetStatusCodeName(status));
+      mfrc522.PICC_HaltA();
+      return;
+    }
+    memcpy(&slowData[page * 4], buffer, 16);
+  }
+  unsigned long slowTime = micros() - start;
+
+  // FAST_READ: up to 15 pages per command
+  start = micros();
+  status = mfrc522.NTAG_ReadPages(PAYLOAD_START_PAGE, PAYLOAD_PAGES, fastData, sizeof(fastData));
+  unsigned long fastTime = micros() - start;
+  if (status != MFRC522::STATUS_OK) {
+    Serial.print(F("NTAG_ReadPages() failed: "));
+    Serial.println(mfrc522.GetStatusCodeName(status));
+    mfrc522.PICC_HaltA();
+    return;
+  }
+
+  Serial.print(F("MIFARE_Read x"));
+  Serial.print((PAYLOAD_PAGES + 3) / 4);
+  Serial.print(F(": "));
+  Serial.print(slowTime);
+  Serial.println(F(" us"));
+  Serial.print(F("FAST_READ x"));
+  Serial.print((PAYLOAD_PAGES + MFRC522::NTAG_FAST_READ_MAX_PAGES - 1) / MFRC522::NTAG_FAST_READ_MAX_PAGES);
+  Serial.print(F(": "));
+  Serial.print(fastTime);
+  Serial.println(F(" us"));
+  Serial.println(memcmp(slowData, fastData, sizeof(fastData)) == 0 ? F("Data matches.") : F("Data differs!"));
+
+  byte signature[34];
+  byte size = sizeof(signature);
+  status = mfrc522.NTAG_ReadSignature(signature, &size);
+  if (status == MFRC522::STATUS_OK) {
+    Serial.print(F("Signature:"));
+    for (byte i = 0; i < 32; i++) {
+      Serial.print(signature[i] < 0x10 ? F(" 0") : F(" "));
+      Serial.print(signature[i], HEX);
+    }
+    Serial.println();
+  } else {
+    Serial.print(F("NTAG_ReadSignature() failed: "));
+    Serial.println(mfrc522.GetStatusCodeName(status));
+  }
+
+  mfrc522.PICC_HaltA();
+}
@@ -212,13 +212,17 @@ public:
 		PICC_CMD_MF_TRANSFER	= 0xB0,		// Writes the contents of the internal data register to a block.
 		// The commands used for MIFARE Ultralight (from http://www.nxp.com/documents/data_sheet/MF0ICU1.pdf, Section 8.6)
 		// The PICC_CMD_MF_READ and PICC_CMD_MF_WRITE can also be used for MIFARE Ultralight.
-		PICC_CMD_UL_WRITE		= 0xA2		// Writes one 4 byte page to the PICC.
+		PICC_CMD_UL_WRITE		= 0xA2,		// Writes one 4 byte page to the PICC.
+		// The commands used for NTAG21x (from https://www.nxp.com/docs/en/data-sheet/NTAG213_215_216.pdf, Section 10)
+		PICC_CMD_NTAG_FAST_READ	= 0x3A,		// Reads the pages from a start to an end address in one frame.
+		PICC_CMD_NTAG_READ_SIG	= 0x3C		// Reads the 32 byte ECC originality signature.
 	};
 	
 	// MIFARE constants that does not fit anywhere else
 	enum MIFARE_Misc {
 		MF_ACK					= 0xA,		// The MIFARE Classic uses a 4 bit ACK/NAK. Any other value than 0xA is NAK.
-		MF_KEY_SIZE				= 6			// A Mifare Crypto1 key is 6 bytes.
+		MF_KEY_SIZE				= 6,		// A Mifare Crypto1 key is 6 bytes.
+		NTAG_FAST_READ_MAX_PAGES	= 15		// (FIFO_SIZE - 2 bytes CRC_A) / 4 bytes per page.
 	};
 	
 	// PICC types we can detect. Remember to update PICC_GetTypeName() if you add more.
@@ -248,6 +252,7 @@ public:
 		STATUS_INTERNAL_ERROR	,	// Internal error in the code. Should not happen ;-)
 		STATUS_INVALID			,	// Invalid argument.
 		STATUS_CRC_WRONG		,	// The CRC_A does not match
+		STATUS_PENDING			,	// A command started with PCD_StartCommand() is still running.
 		STATUS_MIFARE_NACK		= 0xff	// A MIFARE PICC responded with NAK.
 	};
 	
@@ -308,11 +313,17 @@ public:
 	/////////////////////////////////////////////////////////////////////////////////////
 	StatusCode PCD_TransceiveData(byte *sendData, byte sendLen, byte *backData, byte *backLen, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
 	StatusCode PCD_CommunicateWithPICC(byte command, byte waitIRq, byte *sendData, byte sendLen, byte *backData = nullptr, byte *backLen = nullptr, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
+	void PCD_StartCommand(byte command, byte *sendData, byte sendLen, byte txLastBits = 0, byte rxAlign = 0);
+	StatusCode PCD_CheckCommand(byte waitIRq);
+	StatusCode PCD_FinishCommand(byte *backData = nullptr, byte *backLen = nullptr, byte *validBits = nullptr, byte rxAlign = 0, bool checkCRC = false);
 	StatusCode PICC_RequestA(byte *bufferATQA, byte *bufferSize);
 	StatusCode PICC_WakeupA(byte *bufferATQA, byte *bufferSize);
 	StatusCode PICC_REQA_or_WUPA(byte command, byte *bufferATQA, byte *bufferSize);
+	void PICC_BeginRequestA();
+	StatusCode PICC_PollRequestA(byte *bufferATQA, byte *bufferSize);
 	virtual StatusCode PICC_Select(Uid *uid, byte validBits = 0);
 	StatusCode PICC_HaltA();
+	StatusCode PICC_Inventory(Uid *uids, byte *uidCount, uint16_t timeoutMs = 150, bool cardsReady = false);
 
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Functions for communicating with MIFARE PICCs
@@ -329,6 +340,9 @@ public:
 	StatusCode MIFARE_GetValue(byte blockAddr, int32_t *value);
 	StatusCode MIFARE_SetValue(byte blockAddr, int32_t value);
 	StatusCode PCD_NTAG216_AUTH(byte *passWord, byte pACK[]);
+	StatusCode NTAG_FastRead(byte startPage, byte endPage, byte *buffer, byte *bufferSize);
+	StatusCode NTAG_ReadPages(byte startPage, byte pageCount, byte *buffer, uint16_t bufferSize);
+	StatusCode NTAG_ReadSignature(byte *buffer, byte *bufferSize);
 	
 	/////////////////////////////////////////////////////////////////////////////////////
 	// Support functions
@@ -360,11 +374,13 @@ public:
 	// Convenience functions - does not add extra functionality
 	/////////////////////////////////////////////////////////////////////////////////////
 	virtual bool PICC_IsNewCardPresent();
+	bool PICC_IsCardStillPresent(Uid *uid);
 	virtual bool PICC_ReadCardSerial();
 	
 protected:
 	byte _chipSelectPin;		// Arduino pin connected to MFRC522's SPI slave select input (Pin 24, NSS, active low)
 	byte _resetPowerDownPin;	// Arduino pin connected to MFRC522's reset and power down input (Pin 6, NRSTPD, active low)
+	uint32_t _commandDeadline;	// millis() after which a command started with PCD_StartCommand() is considered timed out
 	StatusCode MIFARE_TwoStepHelper(byte command, byte blockAddr, int32_t data);
 };
 
@@ -9,10 +9,22 @@
 #include <SPIFFS.h>  
 
 #define RST_PIN 22   
-#define SS_PIN 21   
-#define pinRele 4    
-#define ledVerde 13   
-#define ledVermelho 14   
+
+// Um leitor RFID por porta. Todos dividem o barramento SPI e o pino RST;
+// cada um tem seu próprio SS, relé e LEDs.
+struct DoorConfig {
+  const char* name;
+  byte ssPin;
+  byte relayPin;
+  byte greenLedPin;
+  byte redLedPin;
+};
+
+const DoorConfig DOORS[] = {
+  { "Entrada", 21, 4, 13, 14 },
+  { "Saida", 17, 16, 25, 26 },
+};
+const byte NUM_DOORS = sizeof(DOORS) / sizeof(DOORS[0]);
 
 const char* WEB_USERNAME = "admin"; 
 const char* WEB_PASSWORD = "123";   
@@ -24,24 +36,79 @@ const char* WIFI_PASSWORD = "D07F134963";
 const unsigned long DOOR_OPEN_DURATION_MS = 1000; 
 const unsigned long LED_FLASH_DURATION_MS = 2000; 
 const unsigned long UID_SCAN_TIMEOUT_MS = 30000; 
-MFRC522 rfid(SS_PIN, RST_PIN);
+const byte MAX_CARDS_PER_TAP = 4;
+const uint16_t INVENTORY_TIMEOUT_MS = 150;
+// Depois de uma leitura o leitor fica em polling contínuo por POLL_ACTIVE_WINDOW_MS.
+// Fora dessa janela ele entra em soft power-down (antena desligada) e só acorda a cada
+// POLL_IDLE_INTERVAL_MS, que é o pior caso de latência de detecção em modo econômico.
+const unsigned long POLL_ACTIVE_WINDOW_MS = 5000;
+const unsigned long POLL_IDLE_INTERVAL_MS = 250;
+// Um cartão já processado é ignorado enquanto continuar no leitor e por até
+// CARD_DEBOUNCE_MS depois da última vez que foi visto. A presença é conferida
+// com WUPA + SELECT da UID conhecida a cada PRESENCE_CHECK_INTERVAL_MS.
+const unsigned long CARD_DEBOUNCE_MS = 3000;
+const unsigned long PRESENCE_CHECK_INTERVAL_MS = 300;
+const byte RECENT_CARDS_PER_READER = 4;
+
+struct RecentCard {
+  MFRC522::Uid uid;
+  unsigned long lastSeen;   // 0 = entrada livre
+};
+
+enum ReaderState {
+  READER_IDLE,       // Pronto para enviar o próximo REQA
+  READER_WAIT_ATQA,  // REQA enviado, aguardando resposta sem bloquear os outros leitores
+  READER_SLEEPING    // Em soft power-down até nextPollTime
+};
+
+struct DoorReader {
+  MFRC522 rfid;
+  ReaderState state;
+  unsigned long pollStartTime;
+  unsigned long prevPollStartTime;
+  unsigned long nextPollTime;
+  unsigned long lastActivityTime;
+  unsigned long antennaOnSince;
+  unsigned long lastPresenceCheck;
+  RecentCard recentCards[RECENT_CARDS_PER_READER];
+  unsigned long relayOffTime;
+  unsigned long greenLedOffTime;
+  unsigned long redLedOffTime;
+
+  // Estatísticas desde o último GET STATS
+  unsigned long pollCount;
+  unsigned long tapCount;
+  unsigned long tapLatencyTotalMs;
+  unsigned long tapLatencyMaxMs;
+  unsigned long detectLatencyMaxMs;
+  unsigned long debouncedCount;
+  unsigned long antennaOnMs;
+  unsigned long statsStartTime;
+};
+
+DoorReader readers[NUM_DOORS];
 AsyncWebServer server(80);
+AsyncRateLimitMiddleware limiteRequisicoes;
 BluetoothSerial SerialBT;
 
+// Status e cabeçalhos das respostas mais comuns, montados uma única vez
+AsyncWebResponseHead textOkHead(200, "text/plain");
+AsyncWebResponseHead unauthorizedHead(401, "text/plain");
+AsyncWebResponseHead jsonOkHead(200, "application/json");
+
 DynamicJsonDocument usersDoc(8192);
+// Revisão do banco de usuários: muda a cada alteração e vira o ETag de /getUsers
+uint32_t usersRevision = 0;
 
 String lastScannedUidForRegistration = "";
 unsigned long lastUidScanTime = 0;
-unsigned long relayOffTime = 0; 
-unsigned long greenLedOffTime = 0; 
-unsigned long redLedOffTime = 0;  
 
 void loadUsers();
 void saveUsers();
 bool addUser(const String& ra, const String& name, const String& uid);
 bool removeUser(const String& ra);
-bool isAuthorized(byte *uid);
-String findUserByUid(byte *uid);
+bool isAuthorized(byte *uid, byte uidSize);
+String findUserByUid(byte *uid, byte uidSize);
 String findUserByRa(const String& ra);
 
 bool isAuthenticated(AsyncWebServerRequest *request); 
@@ -58,13 +125,25 @@ void handleRemoveUser(AsyncWebServerRequest *request);
 
 void handleGetLastScannedUid(AsyncWebServerRequest *request);
 
-void ativarRelePorta();
-void flashLED(int pin);
+void ativarRelePorta(byte door);
+void flashLED(byte door, bool granted);
+void atualizarLeitores();
+bool processarCartoes(byte door, MFRC522::Uid *cards, byte cardCount);
+bool cartaoRecente(byte door, MFRC522::Uid *card);
+void lembrarCartao(byte door, MFRC522::Uid *card);
+void conferirCartoesRecentes(byte door);
+void desligarSaidas(byte door);
+void adormecerLeitor(byte door);
+void acordarLeitor(byte door);
+unsigned long tempoAteProximoEvento();
+String getReaderStats();
 void processarComandoBluetooth(const String& command);
 String getUidHexString(byte *uidBytes, byte uidSize);
 
 
 void loadUsers() {
+  // aleatória no boot, para não repetir um ETag de antes de reiniciar
+  usersRevision = esp_random();
   if (!SPIFFS.begin(false)) { 
     Serial.println("Erro ao montar o SPIFFS para carregar usuários!");
     return;
@@ -89,6 +168,7 @@ void loadUsers() {
 }
 
 void saveUsers() {
+  usersRevision++;
   if (!SPIFFS.begin(false)) { 
     return;
   }
@@ -184,8 +264,8 @@ bool removeUser(const String& ra) {
   return removed;
 }
 
-bool isAuthorized(byte *uid) {
-  String incomingUidHex = getUidHexString(uid, rfid.uid.size);
+bool isAuthorized(byte *uid, byte uidSize) {
+  String incomingUidHex = getUidHexString(uid, uidSize);
   JsonArray usersArray = usersDoc["users"].as<JsonArray>();
   if (!usersArray) {
     return false; 
@@ -198,8 +278,8 @@ bool isAuthorized(byte *uid) {
   return false;
 }
 
-String findUserByUid(byte *uid) {
-  String incomingUidHex = getUidHexString(uid, rfid.uid.size);
+String findUserByUid(byte *uid, byte uidSize) {
+  String incomingUidHex = getUidHexString(uid, uidSize);
   JsonArray usersArray = usersDoc["users"].as<JsonArray>();
   if (!usersArray) {
     return "Erro de Array";
@@ -226,19 +306,269 @@ String findUserByRa(const String& ra) {
 }
 
 
-void ativarRelePorta() {
-  digitalWrite(pinRele, LOW);
-  relayOffTime = millis() + DOOR_OPEN_DURATION_MS;
-  Serial.println("Relé acionado.");
+void ativarRelePorta(byte door) {
+  digitalWrite(DOORS[door].relayPin, LOW);
+  readers[door].relayOffTime = millis() + DOOR_OPEN_DURATION_MS;
+  Serial.print("Relé acionado: ");
+  Serial.println(DOORS[door].name);
+}
+
+void flashLED(byte door, bool granted) {
+  if (granted) {
+    digitalWrite(DOORS[door].greenLedPin, HIGH);
+    readers[door].greenLedOffTime = millis() + LED_FLASH_DURATION_MS;
+  } else {
+    digitalWrite(DOORS[door].redLedPin, HIGH);
+    readers[door].redLedOffTime = millis() + LED_FLASH_DURATION_MS;
+  }
+}
+
+void desligarSaidas(byte door) {
+  DoorReader &reader = readers[door];
+  if (reader.relayOffTime != 0 && millis() >= reader.relayOffTime) {
+    digitalWrite(DOORS[door].relayPin, HIGH);
+    reader.relayOffTime = 0;
+  }
+  if (reader.greenLedOffTime != 0 && millis() >= reader.greenLedOffTime) {
+    digitalWrite(DOORS[door].greenLedPin, LOW);
+    reader.greenLedOffTime = 0;
+  }
+  if (reader.redLedOffTime != 0 && millis() >= reader.redLedOffTime) {
+    digitalWrite(DOORS[door].redLedPin, LOW);
+    reader.redLedOffTime = 0;
+  }
+}
+
+bool cartaoRecente(byte door, MFRC522::Uid *card) {
+  DoorReader &reader = readers[door];
+  for (byte i = 0; i < RECENT_CARDS_PER_READER; i++) {
+    RecentCard &recent = reader.recentCards[i];
+    if (recent.lastSeen == 0 || millis() - recent.lastSeen >= CARD_DEBOUNCE_MS) {
+      continue;
+    }
+    if (recent.uid.size == card->size && memcmp(recent.uid.uidByte, card->uidByte, card->size) == 0) {
+      recent.lastSeen = millis();
+      return true;
+    }
+  }
+  return false;
 }
 
-void flashLED(int pin) {
-  digitalWrite(pin, HIGH);
-  if (pin == ledVerde) {
-    greenLedOffTime = millis() + LED_FLASH_DURATION_MS;
-  } else if (pin == ledVermelho) {
-    redLedOffTime = millis() + LED_FLASH_DURATION_MS;
+void lembrarCartao(byte door, MFRC522::Uid *card) {
+  DoorReader &reader = readers[door];
+  byte slot = 0;
+  for (byte i = 0; i < RECENT_CARDS_PER_READER; i++) {
+    RecentCard &recent = reader.recentCards[i];
+    if (recent.lastSeen == 0 || millis() - recent.lastSeen >= CARD_DEBOUNCE_MS) {
+      slot = i;
+      break;
+    }
+    if (recent.lastSeen < reader.recentCards[slot].lastSeen) {
+      slot = i;
+    }
   }
+  reader.recentCards[slot].uid = *card;
+  reader.recentCards[slot].lastSeen = millis();
+}
+
+// Enquanto um crachá continua encostado no leitor, renova a entrada dele no cache
+// sem refazer REQA, anticolisão e busca de usuário. Quando sai, a entrada é liberada
+// e um novo toque volta a abrir a porta.
+void conferirCartoesRecentes(byte door) {
+  DoorReader &reader = readers[door];
+  if (millis() - reader.lastPresenceCheck < PRESENCE_CHECK_INTERVAL_MS) {
+    return;
+  }
+  reader.lastPresenceCheck = millis();
+
+  for (byte i = 0; i < RECENT_CARDS_PER_READER; i++) {
+    RecentCard &recent = reader.recentCards[i];
+    if (recent.lastSeen == 0) {
+      continue;
+    }
+    if (millis() - recent.lastSeen < CARD_DEBOUNCE_MS && reader.rfid.PICC_IsCardStillPresent(&recent.uid)) {
+      recent.lastSeen = millis();
+    } else {
+      recent.lastSeen = 0;
+    }
+  }
+}
+
+bool processarCartoes(byte door, MFRC522::Uid *cards, byte cardCount) {
+  bool anyNew = false;
+  bool anyAuthorized = false;
+  for (byte i = 0; i < cardCount; i++) {
+    if (cartaoRecente(door, &cards[i])) {
+      readers[door].debouncedCount++;
+      continue;
+    }
+    lembrarCartao(door, &cards[i]);
+    anyNew = true;
+
+    String currentUid = getUidHexString(cards[i].uidByte, cards[i].size);
+
+    lastScannedUidForRegistration = currentUid;
+    lastUidScanTime = millis();
+
+    if (isAuthorized(cards[i].uidByte, cards[i].size)) {
+      String userName = findUserByUid(cards[i].uidByte, cards[i].size);
+      SerialBT.println("RFID " + String(DOORS[door].name) + ": Autorizado - Porta Aberta para " + userName);
+      anyAuthorized = true;
+    } else {
+      SerialBT.println("RFID " + String(DOORS[door].name) + ": Não Autorizado (" + currentUid + ")");
+    }
+  }
+
+  if (!anyNew) {
+    return false;
+  }
+  if (anyAuthorized) {
+    ativarRelePorta(door);
+  }
+  flashLED(door, anyAuthorized);
+  return true;
+}
+
+void adormecerLeitor(byte door) {
+  DoorReader &reader = readers[door];
+  reader.rfid.PCD_SoftPowerDown();
+  reader.antennaOnMs += millis() - reader.antennaOnSince;
+  reader.nextPollTime = reader.pollStartTime + POLL_IDLE_INTERVAL_MS;
+  reader.state = READER_SLEEPING;
+}
+
+void acordarLeitor(byte door) {
+  DoorReader &reader = readers[door];
+  reader.rfid.PCD_SoftPowerUp();
+  reader.antennaOnSince = millis();
+  reader.state = READER_IDLE;
+}
+
+// Agenda os leitores em rodízio: cada chamada avança a máquina de estados de
+// cada leitor um passo, sem esperar os ~25 ms de timeout do REQA de nenhum deles.
+void atualizarLeitores() {
+  for (byte door = 0; door < NUM_DOORS; door++) {
+    DoorReader &reader = readers[door];
+
+    if (reader.state == READER_SLEEPING) {
+      if ((long)(millis() - reader.nextPollTime) < 0) {
+        continue;
+      }
+      acordarLeitor(door);
+    }
+
+    if (reader.state == READER_IDLE) {
+      reader.rfid.PICC_BeginRequestA();
+      reader.prevPollStartTime = reader.pollStartTime;
+      reader.pollStartTime = millis();
+      reader.pollCount++;
+      reader.state = READER_WAIT_ATQA;
+      continue;
+    }
+
+    byte bufferATQA[2];
+    byte bufferSize = sizeof(bufferATQA);
+    MFRC522::StatusCode status = reader.rfid.PICC_PollRequestA(bufferATQA, &bufferSize);
+    if (status == MFRC522::STATUS_PENDING) {
+      continue;
+    }
+    reader.state = READER_IDLE;
+
+    byte cardCount = 0;
+    MFRC522::Uid cards[MAX_CARDS_PER_TAP];
+    if (status == MFRC522::STATUS_OK || status == MFRC522::STATUS_COLLISION) {
+      cardCount = MAX_CARDS_PER_TAP;
+      reader.rfid.PICC_Inventory(cards, &cardCount, INVENTORY_TIMEOUT_MS, true);
+    }
+
+    // Cartões que já estavam no cache não contam como toque: nada de relé, LED
+    // ou log, e o leitor volta a procurar cartões novos no próximo ciclo.
+    bool tapped = cardCount > 0 && processarCartoes(door, cards, cardCount);
+    if (tapped) {
+      reader.rfid.PCD_StopCrypto1();
+
+      unsigned long now = millis();
+      unsigned long latency = now - reader.pollStartTime;
+      // O cartão pode ter chegado logo depois do REQA anterior: esse é o limite da latência de detecção.
+      unsigned long detectLatency = now - reader.prevPollStartTime;
+      reader.lastActivityTime = now;
+      reader.tapCount++;
+      reader.tapLatencyTotalMs += latency;
+      if (latency > reader.tapLatencyMaxMs) {
+        reader.tapLatencyMaxMs = latency;
+      }
+      // Antes do segundo REQA não há ciclo anterior: prevPollStartTime ainda é 0 e a conta daria o uptime.
+      if (reader.prevPollStartTime != 0 && detectLatency > reader.detectLatencyMaxMs) {
+        reader.detectLatencyMaxMs = detectLatency;
+      }
+    } else {
+      conferirCartoesRecentes(door);
+      if (millis() - reader.lastActivityTime >= POLL_ACTIVE_WINDOW_MS) {
+        adormecerLeitor(door);
+      }
+    }
+  }
+}
+
+// Quanto tempo o loop pode dormir sem atrasar um poll nem o desligamento de um relé ou LED.
+unsigned long tempoAteProximoEvento() {
+  unsigned long now = millis();
+  unsigned long wait = POLL_IDLE_INTERVAL_MS;
+  for (byte door = 0; door < NUM_DOORS; door++) {
+    DoorReader &reader = readers[door];
+    if (reader.state != READER_SLEEPING) {
+      return 0;
+    }
+    unsigned long deadlines[] = { reader.nextPollTime, reader.relayOffTime, reader.greenLedOffTime, reader.redLedOffTime };
+    for (byte i = 0; i < 4; i++) {
+      if (deadlines[i] == 0) {
+        continue;
+      }
+      long remaining = (long)(deadlines[i] - now);
+      if (remaining <= 0) {
+        return 0;
+      }
+      if ((unsigned long)remaining < wait) {
+        wait = remaining;
+      }
+    }
+  }
+  return wait;
+}
+
+String getReaderStats() {
+  String stats = "";
+  unsigned long now = millis();
+  for (byte door = 0; door < NUM_DOORS; door++) {
+    DoorReader &reader = readers[door];
+    unsigned long elapsed = now - reader.statsStartTime;
+    float pollRate = elapsed > 0 ? reader.pollCount * 1000.0f / elapsed : 0;
+    unsigned long avgLatency = reader.tapCount > 0 ? reader.tapLatencyTotalMs / reader.tapCount : 0;
+    unsigned long antennaOnMs = reader.antennaOnMs;
+    if (reader.state != READER_SLEEPING) {
+      antennaOnMs += now - reader.antennaOnSince;
+    }
+    float antennaDuty = elapsed > 0 ? antennaOnMs * 100.0f / elapsed : 0;
+
+    stats += String(DOORS[door].name) + ": " + String(pollRate, 1) + " polls/s, " +
+             String(reader.tapCount) + " leituras, latência média " + String(avgLatency) +
+             " ms, máx " + String(reader.tapLatencyMaxMs) + " ms, detecção máx " +
+             String(reader.detectLatencyMaxMs) + " ms, antena ligada " + String(antennaDuty, 1) + "%, " +
+             String(reader.debouncedCount) + " releituras ignoradas\n";
+
+    reader.pollCount = 0;
+    reader.tapCount = 0;
+    reader.tapLatencyTotalMs = 0;
+    reader.tapLatencyMaxMs = 0;
+    reader.detectLatencyMaxMs = 0;
+    reader.debouncedCount = 0;
+    reader.antennaOnMs = 0;
+    if (reader.state != READER_SLEEPING) {
+      reader.antennaOnSince = now;
+    }
+    reader.statsStartTime = now;
+  }
+  return stats;
 }
 
 
@@ -328,7 +658,8 @@ void handleDashboard(AsyncWebServerRequest *request) {
       return;
   }
 
-  String htmlContent = R"rawliteral(<!DOCTYPE html>
+  // Página separada uma única vez em texto e marcadores; %USERNAME% é escrito direto no buffer da resposta
+  static const char dashboardHtml[] PROGMEM = R"rawliteral(<!DOCTYPE html>
     <html>
     <head>
       <title>ModuLock</title>
@@ -423,34 +754,42 @@ void handleDashboard(AsyncWebServerRequest *request) {
       </script>
     </body>
     </html>)rawliteral";
+  static AsyncWebTemplate dashboardTemplate(dashboardHtml);
 
-  htmlContent.replace("%USERNAME%", WEB_USERNAME);
-
-  request->send(200, "text/html", htmlContent);
+  request->send(200, "text/html", dashboardTemplate, [](size_t, Print &out) { out.print(WEB_USERNAME); });
 }
 
 
 void handleAbrirPorta(AsyncWebServerRequest *request) {
   if (!isAuthenticated(request)) {
-      request->send(401, "text/plain", "Não autorizado. Faça login.");
+      request->send(unauthorizedHead, "Não autorizado. Faça login.");
       return;
   }
   SerialBT.println("Web: Porta Aberta");
-  ativarRelePorta();
-  flashLED(ledVerde);
-  request->send(200, "text/plain", "Porta aberta com sucesso!");
+  ativarRelePorta(0);
+  flashLED(0, true);
+  request->send(textOkHead, "Porta aberta com sucesso!");
 }
 
 void handleGetUsuarios(AsyncWebServerRequest *request) {
   Serial.println("Requisição GET para /getUsers.");
   if (!isAuthenticated(request)) {
-      request->send(401, "text/plain", "Não autorizado. Faça login.");
+      request->send(unauthorizedHead, "Não autorizado. Faça login.");
       return;
   }
 
+  // Nada mudou desde a última consulta do navegador: 304 sem serializar o JSON
+  String etag = AsyncWebServerResponse::versionETag(usersRevision);
+  if (request->sendNotModified(etag)) {
+    return;
+  }
+
   String jsonResponse;
   serializeJson(usersDoc, jsonResponse);
-  request->send(200, "application/json", jsonResponse);
+  AsyncWebServerResponse *response = request->beginResponse(jsonOkHead, jsonResponse);
+  response->addHeader("ETag", etag.c_str());
+  response->addHeader("Cache-Control", "no-cache");
+  request->send(response);
 }
 
 void handlePaginaRegistro(AsyncWebServerRequest *request) {
@@ -558,7 +897,7 @@ void handlePaginaRegistro(AsyncWebServerRequest *request) {
 
 void handleRegisterUser(AsyncWebServerRequest *request) {
   if (!isAuthenticated(request)) {
-      request->send(401, "text/plain", "Não autorizado. Faça login como admin.");
+      request->send(unauthorizedHead, "Não autorizado. Faça login como admin.");
       return;
   }
 
@@ -568,10 +907,10 @@ void handleRegisterUser(AsyncWebServerRequest *request) {
     String uid = request->getParam("uid", true)->value();
 
     if (addUser(ra, name, uid)) {
-      request->send(200, "text/plain", "Usuário " + name + " (RA: " + ra + ") registrado com sucesso!");
+      request->send(textOkHead, "Usuário " + name + " (RA: " + ra + ") registrado com sucesso!");
       Serial.println("Usuário registrado: " + name + " (RA: " + ra + ")");
     } else {
-      request->send(200, "text/plain", "Erro: Falha ao registrar usuário. RA ou UID podem já existir ou campos vazios.");
+      request->send(textOkHead, "Erro: Falha ao registrar usuário. RA ou UID podem já existir ou campos vazios.");
     }
   } else {
     request->send(400, "text/plain", "Erro: Parâmetros ausentes para o registro do usuário.");
@@ -582,14 +921,14 @@ void handleRegisterUser(AsyncWebServerRequest *request) {
 void handleRemoveUser(AsyncWebServerRequest *request) {
   Serial.println("Requisição POST recebida para /removeUser.");
   if (!isAuthenticated(request)) {
-      request->send(401, "text/plain", "Não autorizado. Faça login como admin.");
+      request->send(unauthorizedHead, "Não autorizado. Faça login como admin.");
       return;
   }
 
   if (request->hasParam("ra", true)) {
     String raToRemove = request->getParam("ra", true)->value();
     if (removeUser(raToRemove)) {
-      request->send(200, "text/plain", "Usuário com RA '" + raToRemove + "' removido com sucesso.");
+      request->send(textOkHead, "Usuário com RA '" + raToRemove + "' removido com sucesso.");
     } else {
       request->send(404, "text/plain", "Erro: Usuário com RA '" + raToRemove + "' não encontrado ou RA vazio.");
     }
@@ -600,9 +939,9 @@ void handleRemoveUser(AsyncWebServerRequest *request) {
 
 void handleGetLastScannedUid(AsyncWebServerRequest *request) {
   if (lastScannedUidForRegistration.length() > 0 && (millis() - lastUidScanTime < UID_SCAN_TIMEOUT_MS)) {
-    request->send(200, "text/plain", lastScannedUidForRegistration);
+    request->send(textOkHead, lastScannedUidForRegistration);
   } else {
-    request->send(200, "text/plain", "No UID");
+    request->send(textOkHead, "No UID");
   }
 }
 
@@ -620,8 +959,8 @@ void processarComandoBluetooth(const String& command) {
 
   if (cmd == "OPEN DOOR") {
     SerialBT.println("BT: Porta Aberta");
-    ativarRelePorta();
-    flashLED(ledVerde);
+    ativarRelePorta(0);
+    flashLED(0, true);
   } else if (cmd.startsWith("ADD USER ")) {
     int firstComma = cmd.indexOf(',');
     int secondComma = cmd.indexOf(',', firstComma + 1);
@@ -650,9 +989,11 @@ void processarComandoBluetooth(const String& command) {
     serializeJson(usersDoc, jsonResponse);
     SerialBT.print("BT: Usuários Registrados: ");
     SerialBT.println(jsonResponse);
+  } else if (cmd == "GET STATS") {
+    SerialBT.print(getReaderStats());
   }
   else {
-    SerialBT.println("BT: Comando desconhecido. Comandos: OPEN DOOR, ADD USER RA,NOME,UID, REMOVE USER RA, GET USERS");
+    SerialBT.println("BT: Comando desconhecido. Comandos: OPEN DOOR, ADD USER RA,NOME,UID, REMOVE USER RA, GET USERS, GET STATS");
   }
 }
 
@@ -661,14 +1002,21 @@ void processarComandoBluetooth(const String& command) {
 void setup() {
   Serial.begin(115200);
   SPI.begin();
-  rfid.PCD_Init();
 
-  pinMode(pinRele, OUTPUT);
-  pinMode(ledVerde, OUTPUT);
-  pinMode(ledVermelho, OUTPUT);
-  digitalWrite(pinRele, HIGH);
-  digitalWrite(ledVerde, LOW);
-  digitalWrite(ledVermelho, LOW);
+  for (byte door = 0; door < NUM_DOORS; door++) {
+    readers[door].rfid.PCD_Init(DOORS[door].ssPin, RST_PIN);
+    readers[door].state = READER_IDLE;
+    readers[door].statsStartTime = millis();
+    readers[door].antennaOnSince = millis();
+    readers[door].lastActivityTime = millis();
+
+    pinMode(DOORS[door].relayPin, OUTPUT);
+    pinMode(DOORS[door].greenLedPin, OUTPUT);
+    pinMode(DOORS[door].redLedPin, OUTPUT);
+    digitalWrite(DOORS[door].relayPin, HIGH);
+    digitalWrite(DOORS[door].greenLedPin, LOW);
+    digitalWrite(DOORS[door].redLedPin, LOW);
+  }
 
   if (!SPIFFS.begin(true)) {
     Serial.println("Erro ao montar o SPIFFS! Verifique se a partição está correta.");
@@ -693,6 +1041,12 @@ void setup() {
   Serial.print("Endereço IP do ESP32: ");
   Serial.println(WiFi.localIP());
 
+  // Limite por IP: 30 requisições a cada 10 s (a tela de registro consulta o UID a cada segundo)
+  // e só 5 tentativas de login por minuto
+  limiteRequisicoes.setMaxRequests(30);
+  limiteRequisicoes.setWindowSize(10);
+  limiteRequisicoes.addRouteLimit("/login", 5, 60);
+  server.addMiddleware(&limiteRequisicoes);
 
   server.on("/", HTTP_GET, handleRoot);
   server.on("/login", HTTP_POST, handleLogin);
@@ -705,13 +1059,9 @@ void setup() {
   server.on("/removeUser", HTTP_POST, handleRemoveUser);
   server.on("/getLastScannedUid", HTTP_GET, handleGetLastScannedUid);
 
-  server.on("/style.css", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/style.css", "text/css");
-  });
-
-  server.on("/script.js", HTTP_GET, [](AsyncWebServerRequest *request){
-    request->send(SPIFFS, "/script.js", "application/javascript");
-  });
+  // Arquivos estáticos: a busca no SPIFFS fica em cache, cada requisição faz só uma abertura
+  server.serveStatic("/style.css", SPIFFS, "/style.css");
+  server.serveStatic("/script.js", SPIFFS, "/script.js");
 
   server.onNotFound(handleNotFound);
 
@@ -721,41 +1071,22 @@ void setup() {
 
 
 void loop() {
-  if (relayOffTime != 0 && millis() >= relayOffTime) {
-    digitalWrite(pinRele, HIGH);
-    relayOffTime = 0;
-  }
-  if (greenLedOffTime != 0 && millis() >= greenLedOffTime) {
-    digitalWrite(ledVerde, LOW);
-    greenLedOffTime = 0;
+  for (byte door = 0; door < NUM_DOORS; door++) {
+    desligarSaidas(door);
   }
-  if (redLedOffTime != 0 && millis() >= redLedOffTime) {
-    digitalWrite(ledVermelho, LOW);
-    redLedOffTime = 0;
-  }
-
-  if (rfid.PICC_IsNewCardPresent() && rfid.PICC_ReadCardSerial()) {
-    String currentUid = getUidHexString(rfid.uid.uidByte, rfid.uid.size);
-
-    lastScannedUidForRegistration = currentUid;
-    lastUidScanTime = millis();
-
-    if (isAuthorized(rfid.uid.uidByte)) {
-      String userName = findUserByUid(rfid.uid.uidByte);
-      SerialBT.println("RFID: Autorizado - Porta Aberta para " + userName);
-      ativarRelePorta();
-      flashLED(ledVerde);
-    } else {
-      SerialBT.println("RFID: Não Autorizado");
-      flashLED(ledVermelho);
-    }
 
-    rfid.PICC_HaltA();
-    rfid.PCD_StopCrypto1();
-  }
+  atualizarLeitores();
 
   if (SerialBT.available()) {
     String command = SerialBT.readStringUntil('\n');
     processarComandoBluetooth(command);
   }
-}
\ No newline at end of file
+
+  // Com todos os leitores em power-down, libera a CPU até o próximo poll.
+  // O delay() entrega o núcleo à tarefa idle do FreeRTOS, que entra em light sleep
+  // automático quando o gerenciamento de energia está habilitado, sem derrubar Wi-Fi/BT.
+  unsigned long wait = tempoAteProximoEvento();
+  if (wait > 0) {
+    delay(wait);
+  }
+}